@@ -0,0 +1,79 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille, Sylvain Corlay and Wolf Vollprecht    *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <benchmark/benchmark.h>
+
+#include "xtensor/xallocator.hpp"
+#include "xtensor/xstorage.hpp"
+#include "xtensor/xtensor.hpp"
+
+namespace xt
+{
+    namespace allocator_bench
+    {
+        // Random access over a buffer much larger than what the TLB covers
+        // with 4 KiB pages. Run under `perf stat -e dTLB-load-misses` to see
+        // the miss reduction brought by huge pages; the time per iteration
+        // reflects it when the page walks dominate.
+        template <class A>
+        inline void random_access(benchmark::State& state)
+        {
+            using tensor_type = xtensor_container<uvector<double, A>, 1>;
+            std::size_t size = static_cast<std::size_t>(state.range(0));
+            tensor_type x = tensor_type::from_shape({size});
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                x(i) = double(i);
+            }
+
+            // Linear congruential generator, cheap enough not to hide the
+            // memory latency
+            std::uint64_t seed = 42;
+            const std::size_t n_accesses = 1 << 20;
+            for (auto _ : state)
+            {
+                double res = 0.;
+                for (std::size_t i = 0; i < n_accesses; ++i)
+                {
+                    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+                    res += x(static_cast<std::size_t>(seed >> 33) % size);
+                }
+                benchmark::DoNotOptimize(res);
+            }
+            state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n_accesses));
+        }
+
+        // 128 MiB and 1 GiB of doubles
+        BENCHMARK_TEMPLATE(random_access, std::allocator<double>)->Arg(1 << 24)->Arg(1 << 27);
+        BENCHMARK_TEMPLATE(random_access, huge_page_allocator<double>)->Arg(1 << 24)->Arg(1 << 27);
+
+        // Allocation followed by a full write, where the page placement
+        // policy determines which threads fault the pages in
+        template <class A>
+        inline void allocate_and_fill(benchmark::State& state)
+        {
+            using tensor_type = xtensor_container<uvector<double, A>, 1>;
+            std::size_t size = static_cast<std::size_t>(state.range(0));
+            for (auto _ : state)
+            {
+                tensor_type x = tensor_type::from_shape({size});
+                x.fill(1.);
+                benchmark::DoNotOptimize(x.data());
+            }
+        }
+
+        BENCHMARK_TEMPLATE(allocate_and_fill, std::allocator<double>)->Arg(1 << 24);
+        BENCHMARK_TEMPLATE(allocate_and_fill, huge_page_allocator<double>)->Arg(1 << 24);
+        BENCHMARK_TEMPLATE(allocate_and_fill, huge_page_allocator<double, numa_placement::interleave>)->Arg(1 << 24);
+        BENCHMARK_TEMPLATE(allocate_and_fill, huge_page_allocator<double, numa_placement::parallel_first_touch>)->Arg(1 << 24);
+    }
+}
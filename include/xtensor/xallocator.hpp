@@ -0,0 +1,666 @@
+/***************************************************************************
+* Copyright (c) Johan Mabille, Sylvain Corlay and Wolf Vollprecht          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XTENSOR_ALLOCATOR_HPP
+#define XTENSOR_ALLOCATOR_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "xexception.hpp"
+#include "xtensor_config.hpp"
+#include "xutils.hpp"
+
+#ifndef XTENSOR_HUGE_PAGE_SIZE
+#define XTENSOR_HUGE_PAGE_SIZE (std::size_t(1) << 21)
+#endif
+
+// Allocations of at least this many bytes are mapped with huge page advice,
+// smaller ones are forwarded to the global operator new
+#ifndef XTENSOR_HUGE_PAGE_THRESHOLD
+#define XTENSOR_HUGE_PAGE_THRESHOLD XTENSOR_HUGE_PAGE_SIZE
+#endif
+
+namespace xt
+{
+    /**
+     * Placement of the pages of the buffers allocated by huge_page_allocator
+     * on the NUMA nodes.
+     */
+    enum class numa_placement
+    {
+        /// pages are placed on the node of the thread that first touches them
+        local,
+        /// pages are interleaved across all the nodes the process may use
+        interleave,
+        /// pages are touched in parallel at allocation time, as by a parallel fill
+        parallel_first_touch
+    };
+
+    /**
+     * @class huge_page_allocator
+     * @brief Allocator backed by anonymous memory mappings for large buffers.
+     *
+     * Buffers of at least XTENSOR_HUGE_PAGE_THRESHOLD bytes are mapped with
+     * mmap, aligned on XTENSOR_HUGE_PAGE_SIZE and advised to use transparent
+     * huge pages, which reduces TLB misses when accessing huge arrays.
+     * Their pages are placed on the NUMA nodes according to \c P. Smaller
+     * buffers, and all buffers on platforms other than Linux, are allocated
+     * with the global operator new.
+     *
+     * To make it the default allocator of xtensor containers, define
+     * XTENSOR_DEFAULT_ALLOCATOR before including any xtensor header:
+     *
+     * \code{.cpp}
+     * #define XTENSOR_DEFAULT_ALLOCATOR(T) xt::huge_page_allocator<T>
+     * #include <xtensor/xallocator.hpp>
+     * #include <xtensor/xarray.hpp>
+     * \endcode
+     *
+     * @tparam T the type of the allocated elements.
+     * @tparam P the placement of the pages of large buffers.
+     */
+    template <class T, numa_placement P = numa_placement::local>
+    class huge_page_allocator
+    {
+    public:
+
+        using value_type = T;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using reference = T&;
+        using const_reference = const T&;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        using propagate_on_container_move_assignment = std::true_type;
+        using is_always_equal = std::true_type;
+
+        template <class U>
+        struct rebind
+        {
+            using other = huge_page_allocator<U, P>;
+        };
+
+        huge_page_allocator() noexcept = default;
+
+        template <class U>
+        huge_page_allocator(const huge_page_allocator<U, P>&) noexcept;
+
+        T* allocate(size_type n);
+        void deallocate(T* p, size_type n) noexcept;
+
+        size_type max_size() const noexcept;
+
+        static bool is_mapped(size_type n) noexcept;
+        static size_type mapped_size(size_type n) noexcept;
+    };
+
+    template <class T, numa_placement PT, class U, numa_placement PU>
+    bool operator==(const huge_page_allocator<T, PT>&, const huge_page_allocator<U, PU>&) noexcept;
+
+    template <class T, numa_placement PT, class U, numa_placement PU>
+    bool operator!=(const huge_page_allocator<T, PT>&, const huge_page_allocator<U, PU>&) noexcept;
+
+    /**************************************
+     * huge_page_allocator implementation *
+     **************************************/
+
+    namespace detail
+    {
+        // Global operator new and delete, using the aligned overloads
+        // for over-aligned types when they are available
+        template <class T>
+        inline void* aligned_operator_new(std::size_t size)
+        {
+#if defined(__cpp_aligned_new)
+            if (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            {
+                return ::operator new(size, std::align_val_t(alignof(T)));
+            }
+#endif
+            return ::operator new(size);
+        }
+
+        template <class T>
+        inline void aligned_operator_delete(void* p) noexcept
+        {
+#if defined(__cpp_aligned_new)
+            if (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            {
+                ::operator delete(p, std::align_val_t(alignof(T)));
+                return;
+            }
+#endif
+            ::operator delete(p);
+        }
+
+#if defined(__linux__)
+        inline void* map_huge_pages(std::size_t size)
+        {
+            // Over-allocate by one huge page and trim, so that the mapping is
+            // aligned on a huge page boundary and can be backed by huge pages
+            std::size_t align = XTENSOR_HUGE_PAGE_SIZE;
+            void* raw = ::mmap(nullptr, size + align, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (raw == MAP_FAILED)
+            {
+                return nullptr;
+            }
+            std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(raw);
+            std::uintptr_t aligned = (begin + align - 1) & ~(std::uintptr_t(align) - 1);
+            std::size_t head = static_cast<std::size_t>(aligned - begin);
+            if (head != 0)
+            {
+                ::munmap(raw, head);
+            }
+            if (align - head != 0)
+            {
+                ::munmap(reinterpret_cast<void*>(aligned + size), align - head);
+            }
+            void* res = reinterpret_cast<void*>(aligned);
+#if defined(MADV_HUGEPAGE)
+            // Advisory only, the mapping is still usable if THP are disabled
+            ::madvise(res, size, MADV_HUGEPAGE);
+#endif
+            return res;
+        }
+
+        inline void interleave_pages(void* p, std::size_t size)
+        {
+#if defined(SYS_mbind)
+            // MPOL_INTERLEAVE, from <numaif.h>, which would require libnuma.
+            // The kernel restricts the mask to the nodes the process may use.
+            constexpr int mpol_interleave = 3;
+            unsigned long node_mask = ~0UL;
+            // Advisory only, pages are placed on first touch if this fails
+            ::syscall(SYS_mbind, p, size, mpol_interleave, &node_mask,
+                      static_cast<unsigned long>(std::numeric_limits<unsigned long>::digits), 0u);
+#else
+            (void) p;
+            (void) size;
+#endif
+        }
+
+        inline void first_touch_pages(void* p, std::size_t size)
+        {
+            // One write per page, by the thread handling the block holding it
+            std::size_t page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            char* bytes = static_cast<char*>(p);
+            std::size_t n_blocks = parallel_block_count(size, XTENSOR_HUGE_PAGE_SIZE);
+            parallel_for_blocks(n_blocks, size, [bytes, page_size](std::size_t, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; i += page_size)
+                {
+                    bytes[i] = char(0);
+                }
+            });
+        }
+#endif
+    }
+
+    template <class T, numa_placement P>
+    template <class U>
+    inline huge_page_allocator<T, P>::huge_page_allocator(const huge_page_allocator<U, P>&) noexcept
+    {
+    }
+
+    /**
+     * Allocates storage for \c n elements of type T.
+     * @throw allocation_error, a std::bad_alloc, if the allocation fails.
+     */
+    template <class T, numa_placement P>
+    inline T* huge_page_allocator<T, P>::allocate(size_type n)
+    {
+        if (n > max_size())
+        {
+            XTENSOR_THROW(allocation_error, "huge_page_allocator: allocation size exceeds max_size()");
+        }
+#if defined(__linux__)
+        if (is_mapped(n))
+        {
+            size_type size = mapped_size(n);
+            void* res = detail::map_huge_pages(size);
+            if (res == nullptr)
+            {
+                XTENSOR_THROW(allocation_error, "huge_page_allocator: memory mapping failed");
+            }
+            if (P == numa_placement::interleave)
+            {
+                detail::interleave_pages(res, size);
+            }
+            else if (P == numa_placement::parallel_first_touch)
+            {
+                detail::first_touch_pages(res, size);
+            }
+            return static_cast<T*>(res);
+        }
+#endif
+        return static_cast<T*>(detail::aligned_operator_new<T>(n * sizeof(T)));
+    }
+
+    /**
+     * Deallocates the storage of \c n elements pointed to by \c p, which must
+     * have been obtained by a call to allocate(n).
+     */
+    template <class T, numa_placement P>
+    inline void huge_page_allocator<T, P>::deallocate(T* p, size_type n) noexcept
+    {
+#if defined(__linux__)
+        if (is_mapped(n))
+        {
+            ::munmap(static_cast<void*>(p), mapped_size(n));
+            return;
+        }
+#else
+        (void) n;
+#endif
+        detail::aligned_operator_delete<T>(static_cast<void*>(p));
+    }
+
+    template <class T, numa_placement P>
+    inline auto huge_page_allocator<T, P>::max_size() const noexcept -> size_type
+    {
+        return (std::numeric_limits<size_type>::max() - XTENSOR_HUGE_PAGE_SIZE) / sizeof(T);
+    }
+
+    /**
+     * Returns true if a buffer of \c n elements is allocated with a memory
+     * mapping rather than with the global operator new.
+     */
+    template <class T, numa_placement P>
+    inline bool huge_page_allocator<T, P>::is_mapped(size_type n) noexcept
+    {
+#if defined(__linux__)
+        return n * sizeof(T) >= XTENSOR_HUGE_PAGE_THRESHOLD;
+#else
+        (void) n;
+        return false;
+#endif
+    }
+
+    /**
+     * Returns the size in bytes of the memory mapping of a buffer of \c n
+     * elements, i.e. its size rounded up to a multiple of the huge page size.
+     */
+    template <class T, numa_placement P>
+    inline auto huge_page_allocator<T, P>::mapped_size(size_type n) noexcept -> size_type
+    {
+        size_type align = XTENSOR_HUGE_PAGE_SIZE;
+        return (n * sizeof(T) + align - 1) / align * align;
+    }
+
+    template <class T, numa_placement PT, class U, numa_placement PU>
+    inline bool operator==(const huge_page_allocator<T, PT>&, const huge_page_allocator<U, PU>&) noexcept
+    {
+        return PT == PU;
+    }
+
+    template <class T, numa_placement PT, class U, numa_placement PU>
+    inline bool operator!=(const huge_page_allocator<T, PT>& lhs, const huge_page_allocator<U, PU>& rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+    /****************
+     * scoped_arena *
+     ****************/
+
+    /**
+     * @class scoped_arena
+     * @brief Memory pool recycling the buffers of arena_allocator.
+     *
+     * While a scoped_arena is alive, the buffers allocated with
+     * arena_allocator on the thread that created it are rounded up to a
+     * power of two and, when freed, kept in per-size free lists instead of
+     * being returned to the system, up to \c capacity bytes. Subsequent
+     * allocations of the same size class reuse them, which removes the
+     * malloc / free churn of the temporaries created in steady-state compute
+     * loops (evaluations, aliasing-safe assignments, reducer results, sort
+     * scratch buffers).
+     *
+     * Each buffer is allocated on its own, so buffers escaping the scope stay
+     * valid; they are returned to the system when freed after the arena is
+     * destroyed. Arenas can be nested, the innermost one is used.
+     *
+     * \code{.cpp}
+     * #define XTENSOR_DEFAULT_ALLOCATOR(T) xt::arena_allocator<T>
+     * #include <xtensor/xallocator.hpp>
+     * #include <xtensor/xarray.hpp>
+     *
+     * xt::scoped_arena arena(std::size_t(1) << 26);
+     * for (std::size_t i = 0; i < n_steps; ++i)
+     * {
+     *     a = xt::sum(xt::sort(b + a, 1), {1}) * c;
+     * }
+     * \endcode
+     */
+    class scoped_arena
+    {
+    public:
+
+        explicit scoped_arena(std::size_t capacity);
+        ~scoped_arena();
+
+        scoped_arena(const scoped_arena&) = delete;
+        scoped_arena& operator=(const scoped_arena&) = delete;
+
+        scoped_arena(scoped_arena&&) = delete;
+        scoped_arena& operator=(scoped_arena&&) = delete;
+
+        std::size_t capacity() const noexcept;
+        std::size_t cached_bytes() const noexcept;
+        std::size_t reused_count() const noexcept;
+
+        void release() noexcept;
+
+        static scoped_arena* current() noexcept;
+
+        static void* allocate(std::size_t size);
+        static void deallocate(void* p) noexcept;
+
+    private:
+
+        // Power of two size classes, from 64 bytes up to 2^(6 + max_class - 1)
+        static constexpr std::size_t min_class_shift = 6;
+        static constexpr std::size_t max_class = 58;
+        // Class of the buffers that are allocated with their exact size
+        static constexpr std::size_t exact_class = max_class;
+        // Room for the size class in front of each buffer, preserving the
+        // alignment guarantee of operator new
+        static constexpr std::size_t header_size = alignof(std::max_align_t);
+
+        static std::size_t class_of(std::size_t size) noexcept;
+        static std::size_t class_size(std::size_t c) noexcept;
+        static void* new_block(std::size_t size, std::size_t c);
+        static scoped_arena*& current_ref() noexcept;
+
+        void* pop(std::size_t c) noexcept;
+        bool push(void* block, std::size_t c) noexcept;
+
+        std::array<void*, max_class> m_free_lists;
+        std::size_t m_capacity;
+        std::size_t m_cached_bytes;
+        std::size_t m_reused_count;
+        scoped_arena* p_previous;
+    };
+
+    /**
+     * @class arena_allocator
+     * @brief Allocator recycling its buffers through the current scoped_arena.
+     *
+     * Without a scoped_arena alive on the calling thread, buffers are
+     * allocated with the global operator new.
+     *
+     * @tparam T the type of the allocated elements.
+     */
+    template <class T>
+    class arena_allocator
+    {
+    public:
+
+        static_assert(alignof(T) <= alignof(std::max_align_t),
+                      "arena_allocator does not support over-aligned types");
+
+        using value_type = T;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using reference = T&;
+        using const_reference = const T&;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        using propagate_on_container_move_assignment = std::true_type;
+        using is_always_equal = std::true_type;
+
+        template <class U>
+        struct rebind
+        {
+            using other = arena_allocator<U>;
+        };
+
+        arena_allocator() noexcept = default;
+
+        template <class U>
+        arena_allocator(const arena_allocator<U>&) noexcept;
+
+        T* allocate(size_type n);
+        void deallocate(T* p, size_type n) noexcept;
+
+        size_type max_size() const noexcept;
+    };
+
+    template <class T, class U>
+    bool operator==(const arena_allocator<T>&, const arena_allocator<U>&) noexcept;
+
+    template <class T, class U>
+    bool operator!=(const arena_allocator<T>&, const arena_allocator<U>&) noexcept;
+
+    /*******************************
+     * scoped_arena implementation *
+     *******************************/
+
+    /**
+     * Makes the arena the current one of the calling thread.
+     * @param capacity the maximal number of bytes kept in the free lists.
+     */
+    inline scoped_arena::scoped_arena(std::size_t capacity)
+        : m_capacity(capacity), m_cached_bytes(0), m_reused_count(0), p_previous(current_ref())
+    {
+        m_free_lists.fill(nullptr);
+        current_ref() = this;
+    }
+
+    /**
+     * Returns the cached buffers to the system and restores the previous
+     * current arena.
+     */
+    inline scoped_arena::~scoped_arena()
+    {
+        release();
+        current_ref() = p_previous;
+    }
+
+    /**
+     * Returns the maximal number of bytes kept in the free lists.
+     */
+    inline std::size_t scoped_arena::capacity() const noexcept
+    {
+        return m_capacity;
+    }
+
+    /**
+     * Returns the number of bytes currently held in the free lists.
+     */
+    inline std::size_t scoped_arena::cached_bytes() const noexcept
+    {
+        return m_cached_bytes;
+    }
+
+    /**
+     * Returns the number of allocations served from the free lists.
+     */
+    inline std::size_t scoped_arena::reused_count() const noexcept
+    {
+        return m_reused_count;
+    }
+
+    /**
+     * Returns the buffers held in the free lists to the system.
+     */
+    inline void scoped_arena::release() noexcept
+    {
+        for (std::size_t c = 0; c < max_class; ++c)
+        {
+            while (void* block = pop(c))
+            {
+                ::operator delete(block);
+            }
+        }
+        m_cached_bytes = 0;
+    }
+
+    /**
+     * Returns the innermost arena alive on the calling thread, or nullptr.
+     */
+    inline scoped_arena* scoped_arena::current() noexcept
+    {
+        return current_ref();
+    }
+
+    /**
+     * Allocates \c size bytes, from the free lists of the current arena
+     * when possible.
+     */
+    inline void* scoped_arena::allocate(std::size_t size)
+    {
+        scoped_arena* arena = current();
+        if (arena == nullptr || size > arena->m_capacity)
+        {
+            return new_block(size, exact_class);
+        }
+        std::size_t c = class_of(size);
+        if (void* block = arena->pop(c))
+        {
+            arena->m_cached_bytes -= class_size(c);
+            ++(arena->m_reused_count);
+            return static_cast<char*>(block) + header_size;
+        }
+        return new_block(class_size(c), c);
+    }
+
+    /**
+     * Deallocates a buffer obtained from allocate, keeping it in the free
+     * lists of the current arena if it has room for it.
+     */
+    inline void scoped_arena::deallocate(void* p) noexcept
+    {
+        void* block = static_cast<char*>(p) - header_size;
+        std::size_t c = *static_cast<std::size_t*>(block);
+        scoped_arena* arena = current();
+        if (c == exact_class || arena == nullptr || !arena->push(block, c))
+        {
+            ::operator delete(block);
+        }
+    }
+
+    inline std::size_t scoped_arena::class_of(std::size_t size) noexcept
+    {
+        std::size_t c = 0;
+        while ((std::size_t(1) << (c + min_class_shift)) < size)
+        {
+            ++c;
+        }
+        return c;
+    }
+
+    inline std::size_t scoped_arena::class_size(std::size_t c) noexcept
+    {
+        return std::size_t(1) << (c + min_class_shift);
+    }
+
+    inline void* scoped_arena::new_block(std::size_t size, std::size_t c)
+    {
+        if (size > std::numeric_limits<std::size_t>::max() - header_size)
+        {
+            XTENSOR_THROW(allocation_error, "scoped_arena: allocation size too large");
+        }
+        void* block = ::operator new(size + header_size);
+        *static_cast<std::size_t*>(block) = c;
+        return static_cast<char*>(block) + header_size;
+    }
+
+    inline scoped_arena*& scoped_arena::current_ref() noexcept
+    {
+        static thread_local scoped_arena* p_current = nullptr;
+        return p_current;
+    }
+
+    inline void* scoped_arena::pop(std::size_t c) noexcept
+    {
+        void* block = m_free_lists[c];
+        if (block != nullptr)
+        {
+            // The next block of the list is stored after the size class
+            m_free_lists[c] = *reinterpret_cast<void**>(static_cast<char*>(block) + header_size);
+        }
+        return block;
+    }
+
+    inline bool scoped_arena::push(void* block, std::size_t c) noexcept
+    {
+        if (m_cached_bytes + class_size(c) > m_capacity)
+        {
+            return false;
+        }
+        *reinterpret_cast<void**>(static_cast<char*>(block) + header_size) = m_free_lists[c];
+        m_free_lists[c] = block;
+        m_cached_bytes += class_size(c);
+        return true;
+    }
+
+    /**********************************
+     * arena_allocator implementation *
+     **********************************/
+
+    template <class T>
+    template <class U>
+    inline arena_allocator<T>::arena_allocator(const arena_allocator<U>&) noexcept
+    {
+    }
+
+    template <class T>
+    inline T* arena_allocator<T>::allocate(size_type n)
+    {
+        if (n > max_size())
+        {
+            XTENSOR_THROW(allocation_error, "arena_allocator: allocation size exceeds max_size()");
+        }
+        return static_cast<T*>(scoped_arena::allocate(n * sizeof(T)));
+    }
+
+    template <class T>
+    inline void arena_allocator<T>::deallocate(T* p, size_type) noexcept
+    {
+        if (p != nullptr)
+        {
+            scoped_arena::deallocate(static_cast<void*>(p));
+        }
+    }
+
+    template <class T>
+    inline auto arena_allocator<T>::max_size() const noexcept -> size_type
+    {
+        return (std::numeric_limits<size_type>::max() / 2) / sizeof(T);
+    }
+
+    template <class T, class U>
+    inline bool operator==(const arena_allocator<T>&, const arena_allocator<U>&) noexcept
+    {
+        return true;
+    }
+
+    template <class T, class U>
+    inline bool operator!=(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+}
+
+#endif
@@ -109,6 +109,7 @@ namespace xt
         xarray_container();
         explicit xarray_container(const shape_type& shape, layout_type l = L);
         explicit xarray_container(const shape_type& shape, const_reference value, layout_type l = L);
+        explicit xarray_container(uninitialized_t, const shape_type& shape, layout_type l = L);
         explicit xarray_container(const shape_type& shape, const strides_type& strides);
         explicit xarray_container(const shape_type& shape, const strides_type& strides, const_reference value);
         explicit xarray_container(storage_type&& storage, inner_shape_type&& shape, inner_strides_type&& strides);
@@ -303,8 +304,23 @@ namespace xt
     inline xarray_container<EC, L, SC, Tag>::xarray_container(const shape_type& shape, const_reference value, layout_type l)
         : base_type()
     {
-        base_type::resize(shape, l);
-        std::fill(m_storage.begin(), m_storage.end(), value);
+        base_type::resize(shape, l, uninitialized);
+        detail::parallel_fill(m_storage.begin(), m_storage.end(), value);
+    }
+
+    /**
+     * Allocates a xarray_container with the specified shape and layout_type, whose
+     * elements are left uninitialized for trivially default constructible types
+     * when the data container supports it. Elements of other types are
+     * value-initialized, in parallel when TBB or OpenMP is enabled.
+     * @param shape the shape of the xarray_container
+     * @param l the layout_type of the xarray_container
+     */
+    template <class EC, layout_type L, class SC, class Tag>
+    inline xarray_container<EC, L, SC, Tag>::xarray_container(uninitialized_t, const shape_type& shape, layout_type l)
+        : base_type()
+    {
+        base_type::resize(shape, l, uninitialized);
     }
 
     /**
@@ -435,7 +451,7 @@ namespace xt
     inline xarray_container<EC, L, SC, Tag> xarray_container<EC, L, SC, Tag>::from_shape(S&& s)
     {
         shape_type shape = xtl::forward_sequence<shape_type, S>(s);
-        return self_type(shape);
+        return self_type(uninitialized, shape);
     }
 
     template <class EC, layout_type L, class SC, class Tag>
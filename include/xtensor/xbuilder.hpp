@@ -95,14 +95,14 @@ namespace xt
     inline xtensor<T, N, L> empty(const std::array<ST, N>& shape)
     {
         using shape_type = typename xtensor<T, N>::shape_type;
-        return xtensor<T, N, L>(xtl::forward_sequence<shape_type, decltype(shape)>(shape));
+        return xtensor<T, N, L>(uninitialized, xtl::forward_sequence<shape_type, decltype(shape)>(shape));
     }
 
     template <class T, layout_type L = XTENSOR_DEFAULT_LAYOUT, class I, std::size_t N>
     inline xtensor<T, N, L> empty(const I(&shape)[N])
     {
         using shape_type = typename xtensor<T, N>::shape_type;
-        return xtensor<T, N, L>(xtl::forward_sequence<shape_type, decltype(shape)>(shape));
+        return xtensor<T, N, L>(uninitialized, xtl::forward_sequence<shape_type, decltype(shape)>(shape));
     }
 
     template <class T, layout_type L = XTENSOR_DEFAULT_LAYOUT, std::size_t... N>
@@ -127,7 +127,8 @@ namespace xt
 
     /**
      * Create a xcontainer (xarray, xtensor or xtensor_fixed), filled with *fill_value* and of
-     * the same shape, value type and layout as the input xexpression *e*.
+     * the same shape, value type and layout as the input xexpression *e*. The container
+     * is filled in parallel when TBB or OpenMP is enabled.
      *
      * @param e the xexpression from which to extract shape, value type and layout.
      * @param fill_value the value used to set each element of the returned xcontainer.
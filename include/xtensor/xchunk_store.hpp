@@ -0,0 +1,2039 @@
+/***************************************************************************
+* Copyright (c) Johan Mabille, Sylvain Corlay and Wolf Vollprecht          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XTENSOR_CHUNK_STORE_HPP
+#define XTENSOR_CHUNK_STORE_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+#include "xarray.hpp"
+#include "xchunked_array.hpp"
+#include "xnpy.hpp"
+
+namespace xt
+{
+
+    /*********************************
+     * xfile_chunk_store declaration *
+     *********************************/
+
+    template <class S, bool is_const>
+    class xchunk_store_iterator;
+
+    /**
+     * @class xfile_chunk_store
+     * @brief Chunk storage persisting the chunks of an xchunked_array in a directory.
+     *
+     * Each chunk is stored in its own npy file, named after its index in the
+     * grid of chunks (e.g. "1.0.3"), as in the Zarr directory layout. Chunks
+     * are loaded on demand into a bounded LRU cache. Chunks accessed through
+     * non-const methods are considered modified and are written back when they
+     * are evicted, on flush and on destruction. Chunks without a file hold the
+     * fill value.
+     *
+     * When a prefetch depth is set, dereferencing a chunk iterator of the
+     * chunked array starts loading the chunks that follow in the background,
+     * so that reading files overlaps with the processing of the current chunk.
+     *
+     * Each loaded chunk gets its own buffer, which is never reused for another
+     * chunk: a reference to a chunk, or to one of its elements, refers to that
+     * chunk until the chunk is evicted, i.e. until max_cached_chunks other
+     * chunks have been loaded, and dangles afterwards. The chunk last accessed
+     * through a non-const method is not evicted until it has been assigned or
+     * another chunk is modified. An expression that reads more distinct chunks
+     * of the array per element than max_cached_chunks (e.g. a sum of three
+     * views on distant regions) needs a larger cache. Assigning an expression
+     * that involves a chunked array stored in files goes through a compressed
+     * in-memory temporary. The store is not thread-safe.
+     *
+     * @tparam T the value type of the elements.
+     * @tparam L the layout of the chunks.
+     */
+    template <class T, layout_type L = XTENSOR_DEFAULT_LAYOUT>
+    class xfile_chunk_store
+    {
+    public:
+
+        using self_type = xfile_chunk_store<T, L>;
+        using value_type = xarray<T, L>;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using pointer = value_type*;
+        using const_pointer = const value_type*;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using shape_type = std::vector<std::size_t>;
+        using iterator = xchunk_store_iterator<self_type, false>;
+        using const_iterator = xchunk_store_iterator<self_type, true>;
+
+        template <class S>
+        xfile_chunk_store(const std::string& path, const S& chunk_shape, size_type max_cached_chunks = 2, const T& fill_value = T());
+        ~xfile_chunk_store();
+
+        xfile_chunk_store(const xfile_chunk_store&) = delete;
+        xfile_chunk_store& operator=(const xfile_chunk_store&) = delete;
+
+        xfile_chunk_store(xfile_chunk_store&&) = default;
+        xfile_chunk_store& operator=(xfile_chunk_store&& rhs);
+
+        const std::string& path() const noexcept;
+        size_type dimension() const noexcept;
+        size_type size() const noexcept;
+        const shape_type& shape() const noexcept;
+        const shape_type& chunk_shape() const noexcept;
+        size_type max_cached_chunks() const noexcept;
+
+        size_type prefetch_depth() const noexcept;
+        void set_prefetch_depth(size_type depth) noexcept;
+        void prefetch(size_type i) const;
+
+        template <class S>
+        void resize(const S& shape);
+
+        template <class It>
+        reference element(It first, It last);
+
+        template <class It>
+        const_reference element(It first, It last) const;
+
+        reference chunk(size_type i);
+        const_reference chunk(size_type i) const;
+
+        iterator begin();
+        iterator end();
+
+        const_iterator begin() const;
+        const_iterator end() const;
+        const_iterator cbegin() const;
+        const_iterator cend() const;
+
+        void chunk_written(size_type i);
+        void flush();
+
+    private:
+
+        struct cached_chunk
+        {
+            value_type data;
+            size_type index;
+            bool dirty;
+        };
+
+        using cache_type = std::list<cached_chunk>;
+
+        static constexpr size_type no_chunk = std::numeric_limits<size_type>::max();
+
+        cached_chunk& get_chunk(size_type i) const;
+        void evict_chunk() const;
+        void write_chunk(cached_chunk& c) const;
+        std::string chunk_path(size_type i) const;
+
+        static void read_chunk(const std::string& path, const shape_type& chunk_shape,
+                               const T& fill_value, value_type& data);
+
+        std::string m_path;
+        shape_type m_shape;
+        shape_type m_chunk_shape;
+        size_type m_max_cached_chunks;
+        size_type m_prefetch_depth;
+        T m_fill_value;
+        // most recently used chunks first
+        mutable cache_type m_cache;
+        mutable std::unordered_map<size_type, typename cache_type::iterator> m_index;
+        // chunks being loaded in the background
+        mutable std::unordered_map<size_type, std::future<value_type>> m_pending;
+        // chunk being modified, which is not evicted
+        size_type m_pinned;
+    };
+
+    /***********************************
+     * xsparse_chunk_store declaration *
+     ***********************************/
+
+    /**
+     * @class xsparse_chunk_store
+     * @brief In-memory chunk storage that only allocates the chunks holding
+     * values other than a fill value.
+     *
+     * Chunks are not allocated until they are accessed through a non-const
+     * method: const accesses to such chunks return a single chunk holding the
+     * fill value, shared by all of them. When compaction is enabled, a chunk
+     * that is uniformly equal to the fill value after being assigned by the
+     * chunked array is released; compact() releases all such chunks.
+     *
+     * Distinct chunks can be accessed concurrently. A reference to a chunk,
+     * or to one of its elements, is invalidated when the chunk is released.
+     *
+     * @tparam T the value type of the elements.
+     * @tparam L the layout of the chunks.
+     */
+    template <class T, layout_type L = XTENSOR_DEFAULT_LAYOUT>
+    class xsparse_chunk_store
+    {
+    public:
+
+        using self_type = xsparse_chunk_store<T, L>;
+        using value_type = xarray<T, L>;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using pointer = value_type*;
+        using const_pointer = const value_type*;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using shape_type = std::vector<std::size_t>;
+        using iterator = xchunk_store_iterator<self_type, false>;
+        using const_iterator = xchunk_store_iterator<self_type, true>;
+
+        template <class S>
+        explicit xsparse_chunk_store(const S& chunk_shape, const T& fill_value = T(), bool compact_on_write = true);
+        ~xsparse_chunk_store() = default;
+
+        xsparse_chunk_store(const xsparse_chunk_store& rhs);
+        xsparse_chunk_store& operator=(const xsparse_chunk_store& rhs);
+
+        xsparse_chunk_store(xsparse_chunk_store&&) = default;
+        xsparse_chunk_store& operator=(xsparse_chunk_store&&) = default;
+
+        size_type dimension() const noexcept;
+        size_type size() const noexcept;
+        const shape_type& shape() const noexcept;
+        const shape_type& chunk_shape() const noexcept;
+        const T& fill_value() const noexcept;
+        bool compact_on_write() const noexcept;
+
+        template <class S>
+        void resize(const S& shape);
+
+        template <class It>
+        reference element(It first, It last);
+
+        template <class It>
+        const_reference element(It first, It last) const;
+
+        reference chunk(size_type i);
+        const_reference chunk(size_type i) const;
+
+        iterator begin();
+        iterator end();
+
+        const_iterator begin() const;
+        const_iterator end() const;
+        const_iterator cbegin() const;
+        const_iterator cend() const;
+
+        bool is_allocated(size_type i) const noexcept;
+        size_type allocated_chunks() const noexcept;
+
+        bool release_if_uniform(size_type i);
+        size_type compact();
+
+        void chunk_written(size_type i);
+
+    private:
+
+        template <class It>
+        size_type linear_index(It first, It last) const;
+
+        shape_type m_shape;
+        shape_type m_chunk_shape;
+        T m_fill_value;
+        bool m_compact_on_write;
+        value_type m_fill_chunk;
+        std::vector<std::unique_ptr<value_type>> m_chunks;
+    };
+
+    /***************************************
+     * xcompressed_chunk_store declaration *
+     ***************************************/
+
+    /**
+     * @class xcompressed_chunk_store
+     * @brief In-memory chunk storage holding the chunks compressed.
+     *
+     * Chunks are compressed with a lightweight lossless codec: every element
+     * is xored with the previous one, the bytes are grouped by position in the
+     * elements, and runs of equal bytes are run-length encoded. This works best
+     * on slowly varying data. Chunks are decompressed on demand into a bounded
+     * LRU cache; chunks accessed through non-const methods are considered
+     * modified and are compressed again when they are evicted or on flush.
+     * Chunks that were never modified hold the fill value.
+     *
+     * When a prefetch depth is set, dereferencing a chunk iterator of the
+     * chunked array starts decompressing the chunks that follow in the
+     * background.
+     *
+     * Each decompressed chunk gets its own buffer, which is never reused for
+     * another chunk: a reference to a chunk, or to one of its elements, refers
+     * to that chunk until the chunk is evicted, i.e. until max_cached_chunks
+     * other chunks have been decompressed, and dangles afterwards. The chunk
+     * last accessed through a non-const method is not evicted until it has
+     * been assigned or another chunk is modified. An expression that reads
+     * more distinct chunks of the array per element than max_cached_chunks
+     * needs a larger cache. The store is not thread-safe.
+     *
+     * @tparam T the value type of the elements, which must be trivially copyable.
+     * @tparam L the layout of the chunks.
+     */
+    template <class T, layout_type L = XTENSOR_DEFAULT_LAYOUT>
+    class xcompressed_chunk_store
+    {
+    public:
+
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "xcompressed_chunk_store requires a trivially copyable value type");
+
+        using self_type = xcompressed_chunk_store<T, L>;
+        using value_type = xarray<T, L>;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using pointer = value_type*;
+        using const_pointer = const value_type*;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using shape_type = std::vector<std::size_t>;
+        using iterator = xchunk_store_iterator<self_type, false>;
+        using const_iterator = xchunk_store_iterator<self_type, true>;
+
+        template <class S>
+        explicit xcompressed_chunk_store(const S& chunk_shape, size_type max_cached_chunks = 2, const T& fill_value = T());
+        ~xcompressed_chunk_store() = default;
+
+        xcompressed_chunk_store(const xcompressed_chunk_store& rhs);
+        xcompressed_chunk_store& operator=(const xcompressed_chunk_store& rhs);
+
+        xcompressed_chunk_store(xcompressed_chunk_store&&) = default;
+        xcompressed_chunk_store& operator=(xcompressed_chunk_store&&) = default;
+
+        size_type dimension() const noexcept;
+        size_type size() const noexcept;
+        const shape_type& shape() const noexcept;
+        const shape_type& chunk_shape() const noexcept;
+        size_type max_cached_chunks() const noexcept;
+        const T& fill_value() const noexcept;
+
+        size_type prefetch_depth() const noexcept;
+        void set_prefetch_depth(size_type depth) noexcept;
+        void prefetch(size_type i) const;
+
+        template <class S>
+        void resize(const S& shape);
+
+        template <class It>
+        reference element(It first, It last);
+
+        template <class It>
+        const_reference element(It first, It last) const;
+
+        reference chunk(size_type i);
+        const_reference chunk(size_type i) const;
+
+        iterator begin();
+        iterator end();
+
+        const_iterator begin() const;
+        const_iterator end() const;
+        const_iterator cbegin() const;
+        const_iterator cend() const;
+
+        void chunk_written(size_type i);
+        void flush();
+        size_type compressed_size() const noexcept;
+
+    private:
+
+        using buffer_type = std::vector<std::uint8_t>;
+
+        struct cached_chunk
+        {
+            value_type data;
+            size_type index;
+            bool dirty;
+        };
+
+        using cache_type = std::list<cached_chunk>;
+
+        static constexpr size_type no_chunk = std::numeric_limits<size_type>::max();
+
+        cached_chunk& get_chunk(size_type i) const;
+        void evict_chunk() const;
+        void compress_chunk(cached_chunk& c, buffer_type& buffer) const;
+
+        static void decompress_chunk(const buffer_type& compressed, const shape_type& chunk_shape,
+                                     const T& fill_value, value_type& data, buffer_type& buffer);
+
+        shape_type m_shape;
+        shape_type m_chunk_shape;
+        size_type m_max_cached_chunks;
+        size_type m_prefetch_depth;
+        T m_fill_value;
+        // compressed chunks, empty for chunks holding the fill value
+        mutable std::vector<buffer_type> m_chunks;
+        // most recently used chunks first
+        mutable cache_type m_cache;
+        mutable std::unordered_map<size_type, typename cache_type::iterator> m_index;
+        // chunks being decompressed in the background
+        mutable std::unordered_map<size_type, std::future<value_type>> m_pending;
+        mutable buffer_type m_buffer;
+        // chunk being modified, which is not evicted
+        size_type m_pinned;
+    };
+
+    /*************************
+     * xchunk_store_iterator *
+     *************************/
+
+    template <class S, bool is_const>
+    class xchunk_store_iterator
+        : public xtl::xrandom_access_iterator_base<xchunk_store_iterator<S, is_const>,
+                                                   typename S::value_type,
+                                                   typename S::difference_type,
+                                                   std::conditional_t<is_const, typename S::const_pointer, typename S::pointer>,
+                                                   std::conditional_t<is_const, typename S::const_reference, typename S::reference>>
+    {
+    public:
+
+        using self_type = xchunk_store_iterator<S, is_const>;
+        using storage_type = std::conditional_t<is_const, const S, S>;
+        using value_type = typename S::value_type;
+        using reference = std::conditional_t<is_const, typename S::const_reference, typename S::reference>;
+        using pointer = std::conditional_t<is_const, typename S::const_pointer, typename S::pointer>;
+        using size_type = typename S::size_type;
+        using difference_type = typename S::difference_type;
+        using iterator_category = std::random_access_iterator_tag;
+
+        xchunk_store_iterator() = default;
+        xchunk_store_iterator(storage_type* store, size_type index) noexcept;
+
+        self_type& operator++();
+        self_type& operator--();
+
+        self_type& operator+=(difference_type n);
+        self_type& operator-=(difference_type n);
+
+        difference_type operator-(const self_type& rhs) const;
+
+        reference operator*() const;
+        pointer operator->() const;
+
+        bool equal(const self_type& rhs) const;
+        bool less_than(const self_type& rhs) const;
+
+    private:
+
+        storage_type* p_store = nullptr;
+        size_type m_index = 0;
+    };
+
+    template <class S, bool is_const>
+    bool operator==(const xchunk_store_iterator<S, is_const>& lhs,
+                    const xchunk_store_iterator<S, is_const>& rhs);
+
+    template <class S, bool is_const>
+    bool operator<(const xchunk_store_iterator<S, is_const>& lhs,
+                   const xchunk_store_iterator<S, is_const>& rhs);
+
+    /**
+     * Assignment to an xchunked_array stored in files: chunks are written in
+     * place, so the shape of the array cannot change. Expressions involving
+     * chunked arrays stored in files, which may alias the assigned array, are
+     * first evaluated into a compressed in-memory chunked array.
+     */
+    template <class TT, class T, layout_type L>
+    class xchunked_assigner<TT, xfile_chunk_store<T, L>>
+    {
+    public:
+
+        using temporary_type = TT;
+
+        template <class E, class DST>
+        void build_and_assign_temporary(const xexpression<E>& e, DST& dst);
+
+    private:
+
+        template <class E, class DST>
+        void assign_impl(const xexpression<E>& e, DST& dst, std::false_type);
+
+        template <class E, class DST>
+        void assign_impl(const xexpression<E>& e, DST& dst, std::true_type);
+    };
+
+    /**
+     * Assignment to an xchunked_array with sparse chunks: the temporary keeps
+     * the fill value and the compaction policy of the assigned array.
+     */
+    template <class TT, class T, layout_type L>
+    class xchunked_assigner<TT, xsparse_chunk_store<T, L>>
+    {
+    public:
+
+        using temporary_type = TT;
+
+        template <class E, class DST>
+        void build_and_assign_temporary(const xexpression<E>& e, DST& dst);
+    };
+
+    /**
+     * Assignment to an xchunked_array with compressed chunks: the temporary
+     * keeps the cache size and the fill value of the assigned array.
+     */
+    template <class TT, class T, layout_type L>
+    class xchunked_assigner<TT, xcompressed_chunk_store<T, L>>
+    {
+    public:
+
+        using temporary_type = TT;
+
+        template <class E, class DST>
+        void build_and_assign_temporary(const xexpression<E>& e, DST& dst);
+    };
+
+    /**
+     * Creates a chunked array whose chunks are stored in files.
+     * Chunks are read from the files of the given directory, if any, and the
+     * directory is created otherwise.
+     *
+     * @tparam T The type of the elements (e.g. double)
+     * @tparam L The layout_type of the chunks
+     *
+     * @param shape The shape of the array
+     * @param chunk_shape The shape of a chunk
+     * @param path The directory holding the chunk files
+     * @param max_cached_chunks The maximum number of chunks held in memory (default: 2)
+     * @param fill_value The value of the elements of chunks that have no file (default: T())
+     *
+     * @return returns a ``xchunked_array<xfile_chunk_store<T, L>>`` with the given shape and chunk shape.
+     */
+    template <class T, layout_type L = XTENSOR_DEFAULT_LAYOUT, class S>
+    xchunked_array<xfile_chunk_store<T, L>>
+    chunked_file_array(S&& shape, S&& chunk_shape, const std::string& path,
+                       std::size_t max_cached_chunks = 2, const T& fill_value = T());
+
+    template <class T, layout_type L = XTENSOR_DEFAULT_LAYOUT, class S>
+    xchunked_array<xfile_chunk_store<T, L>>
+    chunked_file_array(std::initializer_list<S> shape, std::initializer_list<S> chunk_shape, const std::string& path,
+                       std::size_t max_cached_chunks = 2, const T& fill_value = T());
+
+    /**
+     * Creates a chunked array whose chunks are stored in files, initialized
+     * from an expression.
+     *
+     * @tparam L The layout_type of the chunks
+     *
+     * @param e The expression to initialize the chunked array from
+     * @param chunk_shape The shape of a chunk
+     * @param path The directory holding the chunk files
+     * @param max_cached_chunks The maximum number of chunks held in memory (default: 2)
+     *
+     * @return returns a ``xchunked_array<xfile_chunk_store<T, L>>`` from the given expression, with the given chunk shape.
+     */
+    template <layout_type L = XTENSOR_DEFAULT_LAYOUT, class E, class S>
+    xchunked_array<xfile_chunk_store<typename E::value_type, L>>
+    chunked_file_array(const xexpression<E>& e, S&& chunk_shape, const std::string& path,
+                       std::size_t max_cached_chunks = 2);
+
+    /**
+     * Creates an in-memory chunked array whose chunks are only allocated when
+     * they are accessed through a non-const method.
+     *
+     * @tparam T The type of the elements (e.g. double)
+     * @tparam L The layout_type of the chunks
+     *
+     * @param shape The shape of the array
+     * @param chunk_shape The shape of a chunk
+     * @param fill_value The value of the elements of chunks that are not allocated (default: T())
+     * @param compact_on_write Whether chunks that are uniformly equal to the fill value after an assignment are released (default: true)
+     *
+     * @return returns a ``xchunked_array<xsparse_chunk_store<T, L>>`` with the given shape and chunk shape.
+     */
+    template <class T, layout_type L = XTENSOR_DEFAULT_LAYOUT, class S>
+    xchunked_array<xsparse_chunk_store<T, L>>
+    chunked_sparse_array(S&& shape, S&& chunk_shape, const T& fill_value = T(), bool compact_on_write = true);
+
+    template <class T, layout_type L = XTENSOR_DEFAULT_LAYOUT, class S>
+    xchunked_array<xsparse_chunk_store<T, L>>
+    chunked_sparse_array(std::initializer_list<S> shape, std::initializer_list<S> chunk_shape,
+                         const T& fill_value = T(), bool compact_on_write = true);
+
+    /**
+     * Creates an in-memory chunked array whose chunks are held compressed.
+     *
+     * @tparam T The type of the elements (e.g. double)
+     * @tparam L The layout_type of the chunks
+     *
+     * @param shape The shape of the array
+     * @param chunk_shape The shape of a chunk
+     * @param max_cached_chunks The maximum number of chunks held decompressed (default: 2)
+     * @param fill_value The value of the elements of chunks that were never modified (default: T())
+     *
+     * @return returns a ``xchunked_array<xcompressed_chunk_store<T, L>>`` with the given shape and chunk shape.
+     */
+    template <class T, layout_type L = XTENSOR_DEFAULT_LAYOUT, class S>
+    xchunked_array<xcompressed_chunk_store<T, L>>
+    chunked_compressed_array(S&& shape, S&& chunk_shape, std::size_t max_cached_chunks = 2, const T& fill_value = T());
+
+    template <class T, layout_type L = XTENSOR_DEFAULT_LAYOUT, class S>
+    xchunked_array<xcompressed_chunk_store<T, L>>
+    chunked_compressed_array(std::initializer_list<S> shape, std::initializer_list<S> chunk_shape,
+                             std::size_t max_cached_chunks = 2, const T& fill_value = T());
+
+    /**
+     * Creates an in-memory chunked array whose chunks are held compressed,
+     * initialized from an expression.
+     *
+     * @tparam L The layout_type of the chunks
+     *
+     * @param e The expression to initialize the chunked array from
+     * @param chunk_shape The shape of a chunk
+     * @param max_cached_chunks The maximum number of chunks held decompressed (default: 2)
+     *
+     * @return returns a ``xchunked_array<xcompressed_chunk_store<T, L>>`` from the given expression, with the given chunk shape.
+     */
+    template <layout_type L = XTENSOR_DEFAULT_LAYOUT, class E, class S>
+    xchunked_array<xcompressed_chunk_store<typename E::value_type, L>>
+    chunked_compressed_array(const xexpression<E>& e, S&& chunk_shape, std::size_t max_cached_chunks = 2);
+
+    /************************************
+     * xfile_chunk_store implementation *
+     ************************************/
+
+    namespace detail
+    {
+        inline void create_directory(const std::string& path)
+        {
+#ifdef _WIN32
+            int res = _mkdir(path.c_str());
+#else
+            int res = mkdir(path.c_str(), 0777);
+#endif
+            if (res != 0 && errno != EEXIST)
+            {
+                XTENSOR_THROW(std::runtime_error, "io error: failed to create directory " + path);
+            }
+        }
+    }
+
+    /**
+     * Builds a store of chunks held in the directory \c path, which is created
+     * if it does not exist.
+     * @param path the directory holding the chunk files.
+     * @param chunk_shape the shape of the chunks.
+     * @param max_cached_chunks the maximum number of chunks held in memory.
+     * @param fill_value the value of the elements of chunks that have no file.
+     */
+    template <class T, layout_type L>
+    template <class S>
+    inline xfile_chunk_store<T, L>::xfile_chunk_store(const std::string& path, const S& chunk_shape,
+                                                      size_type max_cached_chunks, const T& fill_value)
+        : m_path(path)
+        , m_chunk_shape(chunk_shape.cbegin(), chunk_shape.cend())
+        , m_max_cached_chunks((std::max)(max_cached_chunks, size_type(1)))
+        , m_prefetch_depth(0)
+        , m_fill_value(fill_value)
+        , m_pinned(no_chunk)
+    {
+        detail::create_directory(m_path);
+    }
+
+    template <class T, layout_type L>
+    inline xfile_chunk_store<T, L>::~xfile_chunk_store()
+    {
+        try
+        {
+            flush();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    template <class T, layout_type L>
+    inline auto xfile_chunk_store<T, L>::operator=(xfile_chunk_store&& rhs) -> self_type&
+    {
+        flush();
+        m_path = std::move(rhs.m_path);
+        m_shape = std::move(rhs.m_shape);
+        m_chunk_shape = std::move(rhs.m_chunk_shape);
+        m_max_cached_chunks = rhs.m_max_cached_chunks;
+        m_prefetch_depth = rhs.m_prefetch_depth;
+        m_fill_value = std::move(rhs.m_fill_value);
+        m_cache = std::move(rhs.m_cache);
+        m_index = std::move(rhs.m_index);
+        m_pending = std::move(rhs.m_pending);
+        m_pinned = rhs.m_pinned;
+        rhs.m_cache.clear();
+        rhs.m_index.clear();
+        rhs.m_pending.clear();
+        rhs.m_pinned = no_chunk;
+        return *this;
+    }
+
+    template <class T, layout_type L>
+    inline auto xfile_chunk_store<T, L>::path() const noexcept -> const std::string&
+    {
+        return m_path;
+    }
+
+    template <class T, layout_type L>
+    inline auto xfile_chunk_store<T, L>::dimension() const noexcept -> size_type
+    {
+        return m_shape.size();
+    }
+
+    /**
+     * Returns the number of chunks.
+     */
+    template <class T, layout_type L>
+    inline auto xfile_chunk_store<T, L>::size() const noexcept -> size_type
+    {
+        return compute_size(m_shape);
+    }
+
+    /**
+     * Returns the shape of the grid of chunks.
+     */
+    template <class T, layout_type L>
+    inline auto xfile_chunk_store<T, L>::shape() const noexcept -> const shape_type&
+    {
+        return m_shape;
+    }
+
+    template <class T, layout_type L>
+    inline auto xfile_chunk_store<T, L>::chunk_shape() const noexcept -> const shape_type&
+    {
+        return m_chunk_shape;
+    }
+
+    template <class T, layout_type L>
+    inline auto xfile_chunk_store<T, L>::max_cached_chunks() const noexcept -> size_type
+    {
+        return m_max_cached_chunks;
+    }
+
+    /**
+     * Returns the number of chunks loaded in the background after the chunk
+     * dereferenced by a chunk iterator; 0 disables prefetching.
+     */
+    template <class T, layout_type L>
+    inline auto xfile_chunk_store<T, L>::prefetch_depth() const noexcept -> size_type
+    {
+        return m_prefetch_depth;
+    }
+
+    /**
+     * Sets the number of chunks loaded in the background after the chunk
+     * dereferenced by a chunk iterator. Prefetched chunks are held in memory
+     * in addition to the cached chunks until they are accessed.
+     */
+    template <class T, layout_type L>
+    inline void xfile_chunk_store<T, L>::set_prefetch_depth(size_type depth) noexcept
+    {
+        m_prefetch_depth = depth;
+    }
+
+    /**
+     * Starts reading the chunk of linear index \c i in the background,
+     * unless it is already held in memory or being loaded.
+     */
+    template <class T, layout_type L>
+    inline void xfile_chunk_store<T, L>::prefetch(size_type i) const
+    {
+        if (i >= size() || m_index.find(i) != m_index.end() || m_pending.find(i) != m_pending.end())
+        {
+            return;
+        }
+        // the task only works on copies, the cache is not accessed concurrently
+        m_pending.emplace(i, std::async(std::launch::async,
+                                        [path = chunk_path(i), chunk_shape = m_chunk_shape, fill_value = m_fill_value]() {
+                                            value_type data;
+                                            read_chunk(path, chunk_shape, fill_value, data);
+                                            return data;
+                                        }));
+    }
+
+    /**
+     * Resizes the grid of chunks. Modified chunks are written back first.
+     */
+    template <class T, layout_type L>
+    template <class S>
+    inline void xfile_chunk_store<T, L>::resize(const S& shape)
+    {
+        flush();
+        m_cache.clear();
+        m_index.clear();
+        m_pending.clear();
+        m_pinned = no_chunk;
+        m_shape.assign(shape.cbegin(), shape.cend());
+    }
+
+    template <class T, layout_type L>
+    template <class It>
+    inline auto xfile_chunk_store<T, L>::element(It first, It last) -> reference
+    {
+        size_type i = 0;
+        for (size_type d = 0; first != last; ++first, ++d)
+        {
+            i = i * m_shape[d] + static_cast<size_type>(*first);
+        }
+        return chunk(i);
+    }
+
+    template <class T, layout_type L>
+    template <class It>
+    inline auto xfile_chunk_store<T, L>::element(It first, It last) const -> const_reference
+    {
+        size_type i = 0;
+        for (size_type d = 0; first != last; ++first, ++d)
+        {
+            i = i * m_shape[d] + static_cast<size_type>(*first);
+        }
+        return chunk(i);
+    }
+
+    /**
+     * Returns the chunk of linear index \c i in the grid, which is considered
+     * as modified. The chunk is not evicted until it has been assigned or
+     * another chunk is modified.
+     */
+    template <class T, layout_type L>
+    inline auto xfile_chunk_store<T, L>::chunk(size_type i) -> reference
+    {
+        cached_chunk& c = get_chunk(i);
+        c.dirty = true;
+        m_pinned = i;
+        return c.data;
+    }
+
+    /**
+     * Returns the chunk of linear index \c i in the grid.
+     */
+    template <class T, layout_type L>
+    inline auto xfile_chunk_store<T, L>::chunk(size_type i) const -> const_reference
+    {
+        return get_chunk(i).data;
+    }
+
+    template <class T, layout_type L>
+    inline auto xfile_chunk_store<T, L>::begin() -> iterator
+    {
+        return iterator(this, 0);
+    }
+
+    template <class T, layout_type L>
+    inline auto xfile_chunk_store<T, L>::end() -> iterator
+    {
+        return iterator(this, size());
+    }
+
+    template <class T, layout_type L>
+    inline auto xfile_chunk_store<T, L>::begin() const -> const_iterator
+    {
+        return cbegin();
+    }
+
+    template <class T, layout_type L>
+    inline auto xfile_chunk_store<T, L>::end() const -> const_iterator
+    {
+        return cend();
+    }
+
+    template <class T, layout_type L>
+    inline auto xfile_chunk_store<T, L>::cbegin() const -> const_iterator
+    {
+        return const_iterator(this, 0);
+    }
+
+    template <class T, layout_type L>
+    inline auto xfile_chunk_store<T, L>::cend() const -> const_iterator
+    {
+        return const_iterator(this, size());
+    }
+
+    /**
+     * Notifies the store that the chunk of linear index \c i has been
+     * assigned, so that it can be evicted again.
+     */
+    template <class T, layout_type L>
+    inline void xfile_chunk_store<T, L>::chunk_written(size_type i)
+    {
+        if (m_pinned == i)
+        {
+            m_pinned = no_chunk;
+        }
+    }
+
+    /**
+     * Writes the modified chunks held in memory to their files.
+     */
+    template <class T, layout_type L>
+    inline void xfile_chunk_store<T, L>::flush()
+    {
+        for (auto& c : m_cache)
+        {
+            if (c.dirty)
+            {
+                write_chunk(c);
+            }
+        }
+    }
+
+    template <class T, layout_type L>
+    inline auto xfile_chunk_store<T, L>::get_chunk(size_type i) const -> cached_chunk&
+    {
+        auto it = m_index.find(i);
+        if (it != m_index.end())
+        {
+            m_cache.splice(m_cache.begin(), m_cache, it->second);
+            return m_cache.front();
+        }
+
+        if (m_cache.size() >= m_max_cached_chunks)
+        {
+            evict_chunk();
+        }
+
+        // the chunk gets its own buffer, so that references to the chunks
+        // still cached never see the data of another chunk
+        m_cache.emplace_front();
+        cached_chunk& c = m_cache.front();
+        c.index = i;
+        c.dirty = false;
+        try
+        {
+            auto pending = m_pending.find(i);
+            if (pending != m_pending.end())
+            {
+                std::future<value_type> f = std::move(pending->second);
+                m_pending.erase(pending);
+                c.data = f.get();
+            }
+            else
+            {
+                read_chunk(chunk_path(i), m_chunk_shape, m_fill_value, c.data);
+            }
+        }
+        catch (...)
+        {
+            m_cache.pop_front();
+            throw;
+        }
+        m_index[i] = m_cache.begin();
+        return c;
+    }
+
+    /**
+     * Writes back and releases the least recently used chunk, except for the
+     * chunk being modified.
+     */
+    template <class T, layout_type L>
+    inline void xfile_chunk_store<T, L>::evict_chunk() const
+    {
+        auto it = m_cache.end();
+        while (it != m_cache.begin())
+        {
+            --it;
+            if (it->index != m_pinned)
+            {
+                if (it->dirty)
+                {
+                    write_chunk(*it);
+                }
+                m_index.erase(it->index);
+                m_cache.erase(it);
+                return;
+            }
+        }
+    }
+
+    template <class T, layout_type L>
+    inline void xfile_chunk_store<T, L>::read_chunk(const std::string& path, const shape_type& chunk_shape,
+                                                    const T& fill_value, value_type& data)
+    {
+        std::ifstream stream(path, std::ifstream::binary);
+        if (!stream)
+        {
+            data.resize(chunk_shape, L == layout_type::dynamic ? XTENSOR_DEFAULT_LAYOUT : L);
+            data.fill(fill_value);
+            return;
+        }
+
+        detail::npy_header header = detail::read_npy_header(stream);
+        layout_type file_layout = header.fortran_order ? layout_type::column_major : layout_type::row_major;
+        if (header.typestring != detail::build_typestring<T>())
+        {
+            XTENSOR_THROW(std::runtime_error, "Cast error: formats not matching " + header.typestring +
+                                              " vs " + detail::build_typestring<T>());
+        }
+        if (header.shape != chunk_shape || (L != layout_type::dynamic && file_layout != L))
+        {
+            XTENSOR_THROW(std::runtime_error, "Chunk file " + path + " does not match the chunk shape or layout");
+        }
+        data.resize(chunk_shape, L == layout_type::dynamic ? file_layout : L);
+        std::streamsize nbytes = static_cast<std::streamsize>(data.size() * sizeof(T));
+        if (!stream.read(reinterpret_cast<char*>(data.data()), nbytes))
+        {
+            XTENSOR_THROW(std::runtime_error, "io error: failed to read chunk file " + path);
+        }
+    }
+
+    template <class T, layout_type L>
+    inline void xfile_chunk_store<T, L>::write_chunk(cached_chunk& c) const
+    {
+        dump_npy(chunk_path(c.index), c.data);
+        c.dirty = false;
+    }
+
+    template <class T, layout_type L>
+    inline std::string xfile_chunk_store<T, L>::chunk_path(size_type i) const
+    {
+        std::string name;
+        for (size_type d = m_shape.size(); d != 0; --d)
+        {
+            std::string index = std::to_string(i % m_shape[d - 1]);
+            name = d == m_shape.size() ? index : index + '.' + name;
+            i /= m_shape[d - 1];
+        }
+        return m_path + '/' + name;
+    }
+
+    /**************************************
+     * xsparse_chunk_store implementation *
+     **************************************/
+
+    /**
+     * Builds a store with no chunk allocated.
+     * @param chunk_shape the shape of the chunks.
+     * @param fill_value the value of the elements of chunks that are not allocated.
+     * @param compact_on_write whether chunks that are uniformly equal to the fill
+     * value after an assignment are released.
+     */
+    template <class T, layout_type L>
+    template <class S>
+    inline xsparse_chunk_store<T, L>::xsparse_chunk_store(const S& chunk_shape, const T& fill_value, bool compact_on_write)
+        : m_chunk_shape(chunk_shape.cbegin(), chunk_shape.cend())
+        , m_fill_value(fill_value)
+        , m_compact_on_write(compact_on_write)
+    {
+        m_fill_chunk.resize(m_chunk_shape, L == layout_type::dynamic ? XTENSOR_DEFAULT_LAYOUT : L);
+        m_fill_chunk.fill(m_fill_value);
+    }
+
+    template <class T, layout_type L>
+    inline xsparse_chunk_store<T, L>::xsparse_chunk_store(const xsparse_chunk_store& rhs)
+        : m_shape(rhs.m_shape)
+        , m_chunk_shape(rhs.m_chunk_shape)
+        , m_fill_value(rhs.m_fill_value)
+        , m_compact_on_write(rhs.m_compact_on_write)
+        , m_fill_chunk(rhs.m_fill_chunk)
+        , m_chunks(rhs.m_chunks.size())
+    {
+        for (size_type i = 0; i < m_chunks.size(); ++i)
+        {
+            if (rhs.m_chunks[i])
+            {
+                m_chunks[i] = std::make_unique<value_type>(*(rhs.m_chunks[i]));
+            }
+        }
+    }
+
+    template <class T, layout_type L>
+    inline auto xsparse_chunk_store<T, L>::operator=(const xsparse_chunk_store& rhs) -> self_type&
+    {
+        self_type tmp(rhs);
+        *this = std::move(tmp);
+        return *this;
+    }
+
+    template <class T, layout_type L>
+    inline auto xsparse_chunk_store<T, L>::dimension() const noexcept -> size_type
+    {
+        return m_shape.size();
+    }
+
+    /**
+     * Returns the number of chunks, allocated or not.
+     */
+    template <class T, layout_type L>
+    inline auto xsparse_chunk_store<T, L>::size() const noexcept -> size_type
+    {
+        return m_chunks.size();
+    }
+
+    /**
+     * Returns the shape of the grid of chunks.
+     */
+    template <class T, layout_type L>
+    inline auto xsparse_chunk_store<T, L>::shape() const noexcept -> const shape_type&
+    {
+        return m_shape;
+    }
+
+    template <class T, layout_type L>
+    inline auto xsparse_chunk_store<T, L>::chunk_shape() const noexcept -> const shape_type&
+    {
+        return m_chunk_shape;
+    }
+
+    template <class T, layout_type L>
+    inline auto xsparse_chunk_store<T, L>::fill_value() const noexcept -> const T&
+    {
+        return m_fill_value;
+    }
+
+    template <class T, layout_type L>
+    inline bool xsparse_chunk_store<T, L>::compact_on_write() const noexcept
+    {
+        return m_compact_on_write;
+    }
+
+    /**
+     * Resizes the grid of chunks. All the chunks are released.
+     */
+    template <class T, layout_type L>
+    template <class S>
+    inline void xsparse_chunk_store<T, L>::resize(const S& shape)
+    {
+        m_shape.assign(shape.cbegin(), shape.cend());
+        m_chunks.clear();
+        m_chunks.resize(compute_size(m_shape));
+    }
+
+    template <class T, layout_type L>
+    template <class It>
+    inline auto xsparse_chunk_store<T, L>::element(It first, It last) -> reference
+    {
+        return chunk(linear_index(first, last));
+    }
+
+    template <class T, layout_type L>
+    template <class It>
+    inline auto xsparse_chunk_store<T, L>::element(It first, It last) const -> const_reference
+    {
+        return chunk(linear_index(first, last));
+    }
+
+    /**
+     * Returns the chunk of linear index \c i in the grid, allocating it
+     * if needed.
+     */
+    template <class T, layout_type L>
+    inline auto xsparse_chunk_store<T, L>::chunk(size_type i) -> reference
+    {
+        auto& c = m_chunks[i];
+        if (!c)
+        {
+            c = std::make_unique<value_type>(m_fill_chunk);
+        }
+        return *c;
+    }
+
+    /**
+     * Returns the chunk of linear index \c i in the grid, or the chunk holding
+     * the fill value if it is not allocated.
+     */
+    template <class T, layout_type L>
+    inline auto xsparse_chunk_store<T, L>::chunk(size_type i) const -> const_reference
+    {
+        const auto& c = m_chunks[i];
+        return c ? *c : m_fill_chunk;
+    }
+
+    template <class T, layout_type L>
+    inline auto xsparse_chunk_store<T, L>::begin() -> iterator
+    {
+        return iterator(this, 0);
+    }
+
+    template <class T, layout_type L>
+    inline auto xsparse_chunk_store<T, L>::end() -> iterator
+    {
+        return iterator(this, size());
+    }
+
+    template <class T, layout_type L>
+    inline auto xsparse_chunk_store<T, L>::begin() const -> const_iterator
+    {
+        return cbegin();
+    }
+
+    template <class T, layout_type L>
+    inline auto xsparse_chunk_store<T, L>::end() const -> const_iterator
+    {
+        return cend();
+    }
+
+    template <class T, layout_type L>
+    inline auto xsparse_chunk_store<T, L>::cbegin() const -> const_iterator
+    {
+        return const_iterator(this, 0);
+    }
+
+    template <class T, layout_type L>
+    inline auto xsparse_chunk_store<T, L>::cend() const -> const_iterator
+    {
+        return const_iterator(this, size());
+    }
+
+    template <class T, layout_type L>
+    inline bool xsparse_chunk_store<T, L>::is_allocated(size_type i) const noexcept
+    {
+        return static_cast<bool>(m_chunks[i]);
+    }
+
+    /**
+     * Returns the number of chunks held in memory.
+     */
+    template <class T, layout_type L>
+    inline auto xsparse_chunk_store<T, L>::allocated_chunks() const noexcept -> size_type
+    {
+        return static_cast<size_type>(std::count_if(m_chunks.cbegin(), m_chunks.cend(),
+                                                    [](const auto& c) { return static_cast<bool>(c); }));
+    }
+
+    /**
+     * Releases the chunk of linear index \c i if all its elements are equal
+     * to the fill value.
+     * @return true if the chunk is not allocated anymore.
+     */
+    template <class T, layout_type L>
+    inline bool xsparse_chunk_store<T, L>::release_if_uniform(size_type i)
+    {
+        auto& c = m_chunks[i];
+        if (c)
+        {
+            const auto& fill = m_fill_value;
+            if (!std::all_of(c->storage().cbegin(), c->storage().cend(), [&fill](const T& v) { return v == fill; }))
+            {
+                return false;
+            }
+            c.reset();
+        }
+        return true;
+    }
+
+    /**
+     * Releases all the chunks whose elements are equal to the fill value.
+     * @return the number of chunks released.
+     */
+    template <class T, layout_type L>
+    inline auto xsparse_chunk_store<T, L>::compact() -> size_type
+    {
+        size_type released = 0;
+        for (size_type i = 0; i < m_chunks.size(); ++i)
+        {
+            if (m_chunks[i] && release_if_uniform(i))
+            {
+                ++released;
+            }
+        }
+        return released;
+    }
+
+    /**
+     * Called by the chunked array after assigning the chunk of linear index
+     * \c i; releases it if compaction is enabled and the chunk is uniform.
+     */
+    template <class T, layout_type L>
+    inline void xsparse_chunk_store<T, L>::chunk_written(size_type i)
+    {
+        if (m_compact_on_write)
+        {
+            release_if_uniform(i);
+        }
+    }
+
+    template <class T, layout_type L>
+    template <class It>
+    inline auto xsparse_chunk_store<T, L>::linear_index(It first, It last) const -> size_type
+    {
+        size_type i = 0;
+        for (size_type d = 0; first != last; ++first, ++d)
+        {
+            i = i * m_shape[d] + static_cast<size_type>(*first);
+        }
+        return i;
+    }
+
+    /******************************************
+     * xcompressed_chunk_store implementation *
+     ******************************************/
+
+    namespace detail
+    {
+        /**
+         * Compresses the n elements of size elem_size pointed to by data: every
+         * byte is xored with the same byte of the previous element, the bytes
+         * are grouped by position in the elements, then runs of equal bytes are
+         * run-length encoded. Slowly varying values thus give long runs of zeros.
+         */
+        inline void chunk_encode(const char* data, std::size_t n, std::size_t elem_size,
+                                 std::vector<std::uint8_t>& out, std::vector<std::uint8_t>& buffer)
+        {
+            const auto* src = reinterpret_cast<const std::uint8_t*>(data);
+            const std::size_t size = n * elem_size;
+            buffer.resize(size);
+            for (std::size_t b = 0; b < elem_size; ++b)
+            {
+                std::uint8_t* dst = buffer.data() + b * n;
+                std::uint8_t previous = 0;
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    std::uint8_t v = src[i * elem_size + b];
+                    dst[i] = static_cast<std::uint8_t>(v ^ previous);
+                    previous = v;
+                }
+            }
+
+            // control byte c < 128: c + 1 literal bytes follow;
+            // c >= 128: the next byte is repeated c - 125 times
+            out.clear();
+            std::size_t i = 0;
+            while (i < size)
+            {
+                std::size_t run = 1;
+                while (i + run < size && run < 130 && buffer[i + run] == buffer[i])
+                {
+                    ++run;
+                }
+                if (run >= 3)
+                {
+                    out.push_back(static_cast<std::uint8_t>(run + 125));
+                    out.push_back(buffer[i]);
+                    i += run;
+                }
+                else
+                {
+                    std::size_t first = i;
+                    do
+                    {
+                        ++i;
+                    } while (i < size && i - first < 128
+                             && !(i + 2 < size && buffer[i] == buffer[i + 1] && buffer[i] == buffer[i + 2]));
+                    out.push_back(static_cast<std::uint8_t>(i - first - 1));
+                    out.insert(out.end(), buffer.cbegin() + static_cast<std::ptrdiff_t>(first),
+                               buffer.cbegin() + static_cast<std::ptrdiff_t>(i));
+                }
+            }
+        }
+
+        /**
+         * Decompresses the output of chunk_encode into the n elements of size
+         * elem_size pointed to by data.
+         */
+        inline void chunk_decode(const std::vector<std::uint8_t>& in, std::size_t n, std::size_t elem_size,
+                                 char* data, std::vector<std::uint8_t>& buffer)
+        {
+            const std::size_t size = n * elem_size;
+            buffer.resize(size);
+            std::size_t pos = 0;
+            auto it = in.cbegin();
+            while (it != in.cend())
+            {
+                std::size_t c = *it++;
+                std::size_t len = c < 128 ? c + 1 : c - 125;
+                if (pos + len > size || (c < 128 ? in.cend() - it < static_cast<std::ptrdiff_t>(len) : it == in.cend()))
+                {
+                    XTENSOR_THROW(std::runtime_error, "Corrupted compressed chunk");
+                }
+                if (c < 128)
+                {
+                    std::copy(it, it + static_cast<std::ptrdiff_t>(len), buffer.begin() + static_cast<std::ptrdiff_t>(pos));
+                    it += static_cast<std::ptrdiff_t>(len);
+                }
+                else
+                {
+                    std::fill_n(buffer.begin() + static_cast<std::ptrdiff_t>(pos), len, *it++);
+                }
+                pos += len;
+            }
+            if (pos != size)
+            {
+                XTENSOR_THROW(std::runtime_error, "Corrupted compressed chunk");
+            }
+
+            auto* dst = reinterpret_cast<std::uint8_t*>(data);
+            for (std::size_t b = 0; b < elem_size; ++b)
+            {
+                const std::uint8_t* src = buffer.data() + b * n;
+                std::uint8_t previous = 0;
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    previous = static_cast<std::uint8_t>(src[i] ^ previous);
+                    dst[i * elem_size + b] = previous;
+                }
+            }
+        }
+    }
+
+    /**
+     * Builds a store with all chunks holding the fill value.
+     * @param chunk_shape the shape of the chunks.
+     * @param max_cached_chunks the maximum number of chunks held decompressed.
+     * @param fill_value the value of the elements of chunks that were never modified.
+     */
+    template <class T, layout_type L>
+    template <class S>
+    inline xcompressed_chunk_store<T, L>::xcompressed_chunk_store(const S& chunk_shape, size_type max_cached_chunks, const T& fill_value)
+        : m_chunk_shape(chunk_shape.cbegin(), chunk_shape.cend())
+        , m_max_cached_chunks((std::max)(max_cached_chunks, size_type(1)))
+        , m_prefetch_depth(0)
+        , m_fill_value(fill_value)
+        , m_pinned(no_chunk)
+    {
+    }
+
+    /**
+     * Copies the chunks of \c rhs, compressing its modified cached chunks;
+     * the cache of the new store is empty.
+     */
+    template <class T, layout_type L>
+    inline xcompressed_chunk_store<T, L>::xcompressed_chunk_store(const xcompressed_chunk_store& rhs)
+        : m_shape(rhs.m_shape)
+        , m_chunk_shape(rhs.m_chunk_shape)
+        , m_max_cached_chunks(rhs.m_max_cached_chunks)
+        , m_prefetch_depth(rhs.m_prefetch_depth)
+        , m_fill_value(rhs.m_fill_value)
+        , m_chunks(rhs.m_chunks)
+        , m_pinned(no_chunk)
+    {
+        for (const auto& c : rhs.m_cache)
+        {
+            if (c.dirty)
+            {
+                detail::chunk_encode(reinterpret_cast<const char*>(c.data.data()), c.data.size(), sizeof(T),
+                                     m_chunks[c.index], m_buffer);
+            }
+        }
+    }
+
+    template <class T, layout_type L>
+    inline auto xcompressed_chunk_store<T, L>::operator=(const xcompressed_chunk_store& rhs) -> self_type&
+    {
+        self_type tmp(rhs);
+        *this = std::move(tmp);
+        return *this;
+    }
+
+    template <class T, layout_type L>
+    inline auto xcompressed_chunk_store<T, L>::dimension() const noexcept -> size_type
+    {
+        return m_shape.size();
+    }
+
+    /**
+     * Returns the number of chunks.
+     */
+    template <class T, layout_type L>
+    inline auto xcompressed_chunk_store<T, L>::size() const noexcept -> size_type
+    {
+        return m_chunks.size();
+    }
+
+    /**
+     * Returns the shape of the grid of chunks.
+     */
+    template <class T, layout_type L>
+    inline auto xcompressed_chunk_store<T, L>::shape() const noexcept -> const shape_type&
+    {
+        return m_shape;
+    }
+
+    template <class T, layout_type L>
+    inline auto xcompressed_chunk_store<T, L>::chunk_shape() const noexcept -> const shape_type&
+    {
+        return m_chunk_shape;
+    }
+
+    template <class T, layout_type L>
+    inline auto xcompressed_chunk_store<T, L>::max_cached_chunks() const noexcept -> size_type
+    {
+        return m_max_cached_chunks;
+    }
+
+    template <class T, layout_type L>
+    inline auto xcompressed_chunk_store<T, L>::fill_value() const noexcept -> const T&
+    {
+        return m_fill_value;
+    }
+
+    /**
+     * Returns the number of chunks loaded in the background after the chunk
+     * dereferenced by a chunk iterator; 0 disables prefetching.
+     */
+    template <class T, layout_type L>
+    inline auto xcompressed_chunk_store<T, L>::prefetch_depth() const noexcept -> size_type
+    {
+        return m_prefetch_depth;
+    }
+
+    /**
+     * Sets the number of chunks loaded in the background after the chunk
+     * dereferenced by a chunk iterator. Prefetched chunks are held in memory
+     * in addition to the cached chunks until they are accessed.
+     */
+    template <class T, layout_type L>
+    inline void xcompressed_chunk_store<T, L>::set_prefetch_depth(size_type depth) noexcept
+    {
+        m_prefetch_depth = depth;
+    }
+
+    /**
+     * Starts decompressing the chunk of linear index \c i in the background,
+     * unless it is already held in memory or being loaded.
+     */
+    template <class T, layout_type L>
+    inline void xcompressed_chunk_store<T, L>::prefetch(size_type i) const
+    {
+        if (i >= size() || m_index.find(i) != m_index.end() || m_pending.find(i) != m_pending.end())
+        {
+            return;
+        }
+        // the task only works on copies, the cache is not accessed concurrently
+        m_pending.emplace(i, std::async(std::launch::async,
+                                        [compressed = m_chunks[i], chunk_shape = m_chunk_shape, fill_value = m_fill_value]() {
+                                            value_type data;
+                                            buffer_type buffer;
+                                            decompress_chunk(compressed, chunk_shape, fill_value, data, buffer);
+                                            return data;
+                                        }));
+    }
+
+    /**
+     * Resizes the grid of chunks. All the chunks are reset to the fill value.
+     */
+    template <class T, layout_type L>
+    template <class S>
+    inline void xcompressed_chunk_store<T, L>::resize(const S& shape)
+    {
+        m_cache.clear();
+        m_index.clear();
+        m_pending.clear();
+        m_pinned = no_chunk;
+        m_shape.assign(shape.cbegin(), shape.cend());
+        m_chunks.clear();
+        m_chunks.resize(compute_size(m_shape));
+    }
+
+    template <class T, layout_type L>
+    template <class It>
+    inline auto xcompressed_chunk_store<T, L>::element(It first, It last) -> reference
+    {
+        size_type i = 0;
+        for (size_type d = 0; first != last; ++first, ++d)
+        {
+            i = i * m_shape[d] + static_cast<size_type>(*first);
+        }
+        return chunk(i);
+    }
+
+    template <class T, layout_type L>
+    template <class It>
+    inline auto xcompressed_chunk_store<T, L>::element(It first, It last) const -> const_reference
+    {
+        size_type i = 0;
+        for (size_type d = 0; first != last; ++first, ++d)
+        {
+            i = i * m_shape[d] + static_cast<size_type>(*first);
+        }
+        return chunk(i);
+    }
+
+    /**
+     * Returns the chunk of linear index \c i in the grid, which is considered
+     * as modified. The chunk is not evicted until it has been assigned or
+     * another chunk is modified.
+     */
+    template <class T, layout_type L>
+    inline auto xcompressed_chunk_store<T, L>::chunk(size_type i) -> reference
+    {
+        cached_chunk& c = get_chunk(i);
+        c.dirty = true;
+        m_pinned = i;
+        return c.data;
+    }
+
+    /**
+     * Returns the chunk of linear index \c i in the grid.
+     */
+    template <class T, layout_type L>
+    inline auto xcompressed_chunk_store<T, L>::chunk(size_type i) const -> const_reference
+    {
+        return get_chunk(i).data;
+    }
+
+    template <class T, layout_type L>
+    inline auto xcompressed_chunk_store<T, L>::begin() -> iterator
+    {
+        return iterator(this, 0);
+    }
+
+    template <class T, layout_type L>
+    inline auto xcompressed_chunk_store<T, L>::end() -> iterator
+    {
+        return iterator(this, size());
+    }
+
+    template <class T, layout_type L>
+    inline auto xcompressed_chunk_store<T, L>::begin() const -> const_iterator
+    {
+        return cbegin();
+    }
+
+    template <class T, layout_type L>
+    inline auto xcompressed_chunk_store<T, L>::end() const -> const_iterator
+    {
+        return cend();
+    }
+
+    template <class T, layout_type L>
+    inline auto xcompressed_chunk_store<T, L>::cbegin() const -> const_iterator
+    {
+        return const_iterator(this, 0);
+    }
+
+    template <class T, layout_type L>
+    inline auto xcompressed_chunk_store<T, L>::cend() const -> const_iterator
+    {
+        return const_iterator(this, size());
+    }
+
+    /**
+     * Notifies the store that the chunk of linear index \c i has been
+     * assigned, so that it can be evicted again.
+     */
+    template <class T, layout_type L>
+    inline void xcompressed_chunk_store<T, L>::chunk_written(size_type i)
+    {
+        if (m_pinned == i)
+        {
+            m_pinned = no_chunk;
+        }
+    }
+
+    /**
+     * Compresses the modified chunks held in the cache. Chunks are compressed
+     * in parallel when TBB or OpenMP is enabled.
+     */
+    template <class T, layout_type L>
+    inline void xcompressed_chunk_store<T, L>::flush()
+    {
+        std::vector<cached_chunk*> dirty;
+        for (auto& c : m_cache)
+        {
+            if (c.dirty)
+            {
+                dirty.push_back(&c);
+            }
+        }
+
+        std::size_t n_blocks = detail::parallel_block_count(dirty.size(), 1);
+        std::vector<std::exception_ptr> errors(n_blocks);
+        detail::parallel_for_blocks(n_blocks, dirty.size(), [&](std::size_t b, std::size_t begin, std::size_t end) {
+            try
+            {
+                buffer_type buffer;
+                for (std::size_t i = begin; i != end; ++i)
+                {
+                    compress_chunk(*dirty[i], buffer);
+                }
+            }
+            catch (...)
+            {
+                errors[b] = std::current_exception();
+            }
+        });
+        for (const auto& error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    /**
+     * Returns the number of bytes of the compressed chunks. Modified chunks
+     * held in the cache are accounted for their size when they were last
+     * compressed.
+     */
+    template <class T, layout_type L>
+    inline auto xcompressed_chunk_store<T, L>::compressed_size() const noexcept -> size_type
+    {
+        return std::accumulate(m_chunks.cbegin(), m_chunks.cend(), size_type(0),
+                               [](size_type n, const buffer_type& b) { return n + b.size(); });
+    }
+
+    template <class T, layout_type L>
+    inline auto xcompressed_chunk_store<T, L>::get_chunk(size_type i) const -> cached_chunk&
+    {
+        auto it = m_index.find(i);
+        if (it != m_index.end())
+        {
+            m_cache.splice(m_cache.begin(), m_cache, it->second);
+            return m_cache.front();
+        }
+
+        if (m_cache.size() >= m_max_cached_chunks)
+        {
+            evict_chunk();
+        }
+
+        // the chunk gets its own buffer, so that references to the chunks
+        // still cached never see the data of another chunk
+        m_cache.emplace_front();
+        cached_chunk& c = m_cache.front();
+        c.index = i;
+        c.dirty = false;
+        try
+        {
+            auto pending = m_pending.find(i);
+            if (pending != m_pending.end())
+            {
+                std::future<value_type> f = std::move(pending->second);
+                m_pending.erase(pending);
+                c.data = f.get();
+            }
+            else
+            {
+                decompress_chunk(m_chunks[i], m_chunk_shape, m_fill_value, c.data, m_buffer);
+            }
+        }
+        catch (...)
+        {
+            m_cache.pop_front();
+            throw;
+        }
+        m_index[i] = m_cache.begin();
+        return c;
+    }
+
+    /**
+     * Compresses and releases the least recently used chunk, except for the
+     * chunk being modified.
+     */
+    template <class T, layout_type L>
+    inline void xcompressed_chunk_store<T, L>::evict_chunk() const
+    {
+        auto it = m_cache.end();
+        while (it != m_cache.begin())
+        {
+            --it;
+            if (it->index != m_pinned)
+            {
+                if (it->dirty)
+                {
+                    compress_chunk(*it, m_buffer);
+                }
+                m_index.erase(it->index);
+                m_cache.erase(it);
+                return;
+            }
+        }
+    }
+
+    template <class T, layout_type L>
+    inline void xcompressed_chunk_store<T, L>::decompress_chunk(const buffer_type& compressed, const shape_type& chunk_shape,
+                                                                const T& fill_value, value_type& data, buffer_type& buffer)
+    {
+        data.resize(chunk_shape, L == layout_type::dynamic ? XTENSOR_DEFAULT_LAYOUT : L);
+        if (compressed.empty())
+        {
+            data.fill(fill_value);
+        }
+        else
+        {
+            detail::chunk_decode(compressed, data.size(), sizeof(T), reinterpret_cast<char*>(data.data()), buffer);
+        }
+    }
+
+    template <class T, layout_type L>
+    inline void xcompressed_chunk_store<T, L>::compress_chunk(cached_chunk& c, buffer_type& buffer) const
+    {
+        buffer_type& compressed = m_chunks[c.index];
+        detail::chunk_encode(reinterpret_cast<const char*>(c.data.data()), c.data.size(), sizeof(T), compressed, buffer);
+        compressed.shrink_to_fit();
+        c.dirty = false;
+    }
+
+    /****************************************
+     * xchunk_store_iterator implementation *
+     ****************************************/
+
+    template <class S, bool is_const>
+    inline xchunk_store_iterator<S, is_const>::xchunk_store_iterator(storage_type* store, size_type index) noexcept
+        : p_store(store), m_index(index)
+    {
+    }
+
+    template <class S, bool is_const>
+    inline auto xchunk_store_iterator<S, is_const>::operator++() -> self_type&
+    {
+        ++m_index;
+        return *this;
+    }
+
+    template <class S, bool is_const>
+    inline auto xchunk_store_iterator<S, is_const>::operator--() -> self_type&
+    {
+        --m_index;
+        return *this;
+    }
+
+    template <class S, bool is_const>
+    inline auto xchunk_store_iterator<S, is_const>::operator+=(difference_type n) -> self_type&
+    {
+        m_index = static_cast<size_type>(static_cast<difference_type>(m_index) + n);
+        return *this;
+    }
+
+    template <class S, bool is_const>
+    inline auto xchunk_store_iterator<S, is_const>::operator-=(difference_type n) -> self_type&
+    {
+        m_index = static_cast<size_type>(static_cast<difference_type>(m_index) - n);
+        return *this;
+    }
+
+    template <class S, bool is_const>
+    inline auto xchunk_store_iterator<S, is_const>::operator-(const self_type& rhs) const -> difference_type
+    {
+        return static_cast<difference_type>(m_index) - static_cast<difference_type>(rhs.m_index);
+    }
+
+    template <class S, bool is_const>
+    inline auto xchunk_store_iterator<S, is_const>::operator*() const -> reference
+    {
+        return p_store->chunk(m_index);
+    }
+
+    template <class S, bool is_const>
+    inline auto xchunk_store_iterator<S, is_const>::operator->() const -> pointer
+    {
+        return &(p_store->chunk(m_index));
+    }
+
+    template <class S, bool is_const>
+    inline bool xchunk_store_iterator<S, is_const>::equal(const self_type& rhs) const
+    {
+        return p_store == rhs.p_store && m_index == rhs.m_index;
+    }
+
+    template <class S, bool is_const>
+    inline bool xchunk_store_iterator<S, is_const>::less_than(const self_type& rhs) const
+    {
+        return m_index < rhs.m_index;
+    }
+
+    template <class S, bool is_const>
+    inline bool operator==(const xchunk_store_iterator<S, is_const>& lhs,
+                           const xchunk_store_iterator<S, is_const>& rhs)
+    {
+        return lhs.equal(rhs);
+    }
+
+    template <class S, bool is_const>
+    inline bool operator<(const xchunk_store_iterator<S, is_const>& lhs,
+                          const xchunk_store_iterator<S, is_const>& rhs)
+    {
+        return lhs.less_than(rhs);
+    }
+
+    namespace detail
+    {
+        template <class T, layout_type L>
+        struct is_concurrent_chunk_storage<xfile_chunk_store<T, L>> : std::false_type
+        {
+        };
+
+        template <class T, layout_type L>
+        struct is_concurrent_chunk_storage<xcompressed_chunk_store<T, L>> : std::false_type
+        {
+        };
+
+        template <class CS>
+        struct is_chunked_array_of
+        {
+            template <class E>
+            using type = std::is_same<E, xchunked_array<CS>>;
+        };
+
+        /**
+         * Whether the expression E involves chunked arrays with chunk storage CS.
+         */
+        template <class CS, class E>
+        using has_chunk_storage = any_expression_node<is_chunked_array_of<CS>::template type, E>;
+    }
+
+    /************************************
+     * xchunked_assigner implementation *
+     ************************************/
+
+    template <class TT, class T, layout_type L>
+    template <class E, class DST>
+    inline void xchunked_assigner<TT, xfile_chunk_store<T, L>>::build_and_assign_temporary(const xexpression<E>& e, DST& dst)
+    {
+        const auto& shape = e.derived_cast().shape();
+        if (shape.size() != dst.dimension() || !std::equal(shape.cbegin(), shape.cend(), dst.shape().cbegin()))
+        {
+            XTENSOR_THROW(std::runtime_error, "Cannot change the shape of a chunked array stored in files");
+        }
+        assign_impl(e, dst, detail::has_chunk_storage<xfile_chunk_store<T, L>, std::decay_t<E>>());
+    }
+
+    template <class TT, class T, layout_type L>
+    template <class E, class DST>
+    inline void xchunked_assigner<TT, xfile_chunk_store<T, L>>::assign_impl(const xexpression<E>& e, DST& dst, std::false_type)
+    {
+        dst.assign_xexpression(e);
+    }
+
+    template <class TT, class T, layout_type L>
+    template <class E, class DST>
+    inline void xchunked_assigner<TT, xfile_chunk_store<T, L>>::assign_impl(const xexpression<E>& e, DST& dst, std::true_type)
+    {
+        // the chunks of dst read by e would be overwritten before being read
+        using temporary_storage = xcompressed_chunk_store<T, L>;
+        xchunked_array<temporary_storage> tmp(e, temporary_storage(dst.chunk_shape(), dst.chunks().max_cached_chunks()),
+                                              dst.chunk_shape());
+        dst.assign_xexpression(tmp);
+    }
+
+    template <class TT, class T, layout_type L>
+    template <class E, class DST>
+    inline void xchunked_assigner<TT, xsparse_chunk_store<T, L>>::build_and_assign_temporary(const xexpression<E>& e, DST& dst)
+    {
+        using chunk_storage = xsparse_chunk_store<T, L>;
+        const chunk_storage& chunks = dst.chunks();
+        temporary_type tmp(e, chunk_storage(dst.chunk_shape(), chunks.fill_value(), chunks.compact_on_write()), dst.chunk_shape());
+        dst = std::move(tmp);
+    }
+
+    template <class TT, class T, layout_type L>
+    template <class E, class DST>
+    inline void xchunked_assigner<TT, xcompressed_chunk_store<T, L>>::build_and_assign_temporary(const xexpression<E>& e, DST& dst)
+    {
+        using chunk_storage = xcompressed_chunk_store<T, L>;
+        const chunk_storage& chunks = dst.chunks();
+        temporary_type tmp(e, chunk_storage(dst.chunk_shape(), chunks.max_cached_chunks(), chunks.fill_value()), dst.chunk_shape());
+        dst = std::move(tmp);
+    }
+
+    /*************************************
+     * chunked_file_array implementation *
+     *************************************/
+
+    template <class T, layout_type L, class S>
+    inline xchunked_array<xfile_chunk_store<T, L>>
+    chunked_file_array(S&& shape, S&& chunk_shape, const std::string& path, std::size_t max_cached_chunks, const T& fill_value)
+    {
+        using chunk_storage = xfile_chunk_store<T, L>;
+        return xchunked_array<chunk_storage>(chunk_storage(path, chunk_shape, max_cached_chunks, fill_value),
+                                             std::forward<S>(shape), std::forward<S>(chunk_shape));
+    }
+
+    template <class T, layout_type L, class S>
+    inline xchunked_array<xfile_chunk_store<T, L>>
+    chunked_file_array(std::initializer_list<S> shape, std::initializer_list<S> chunk_shape, const std::string& path,
+                       std::size_t max_cached_chunks, const T& fill_value)
+    {
+        using sh_type = std::vector<std::size_t>;
+        auto sh = xtl::forward_sequence<sh_type, std::initializer_list<S>>(shape);
+        auto ch_sh = xtl::forward_sequence<sh_type, std::initializer_list<S>>(chunk_shape);
+        return chunked_file_array<T, L, sh_type>(std::move(sh), std::move(ch_sh), path, max_cached_chunks, fill_value);
+    }
+
+    template <layout_type L, class E, class S>
+    inline xchunked_array<xfile_chunk_store<typename E::value_type, L>>
+    chunked_file_array(const xexpression<E>& e, S&& chunk_shape, const std::string& path, std::size_t max_cached_chunks)
+    {
+        using chunk_storage = xfile_chunk_store<typename E::value_type, L>;
+        return xchunked_array<chunk_storage>(e, chunk_storage(path, chunk_shape, max_cached_chunks),
+                                             std::forward<S>(chunk_shape));
+    }
+
+    /***************************************
+     * chunked_sparse_array implementation *
+     ***************************************/
+
+    template <class T, layout_type L, class S>
+    inline xchunked_array<xsparse_chunk_store<T, L>>
+    chunked_sparse_array(S&& shape, S&& chunk_shape, const T& fill_value, bool compact_on_write)
+    {
+        using chunk_storage = xsparse_chunk_store<T, L>;
+        return xchunked_array<chunk_storage>(chunk_storage(chunk_shape, fill_value, compact_on_write),
+                                             std::forward<S>(shape), std::forward<S>(chunk_shape));
+    }
+
+    template <class T, layout_type L, class S>
+    inline xchunked_array<xsparse_chunk_store<T, L>>
+    chunked_sparse_array(std::initializer_list<S> shape, std::initializer_list<S> chunk_shape,
+                         const T& fill_value, bool compact_on_write)
+    {
+        using sh_type = std::vector<std::size_t>;
+        auto sh = xtl::forward_sequence<sh_type, std::initializer_list<S>>(shape);
+        auto ch_sh = xtl::forward_sequence<sh_type, std::initializer_list<S>>(chunk_shape);
+        return chunked_sparse_array<T, L, sh_type>(std::move(sh), std::move(ch_sh), fill_value, compact_on_write);
+    }
+
+    /*******************************************
+     * chunked_compressed_array implementation *
+     *******************************************/
+
+    template <class T, layout_type L, class S>
+    inline xchunked_array<xcompressed_chunk_store<T, L>>
+    chunked_compressed_array(S&& shape, S&& chunk_shape, std::size_t max_cached_chunks, const T& fill_value)
+    {
+        using chunk_storage = xcompressed_chunk_store<T, L>;
+        return xchunked_array<chunk_storage>(chunk_storage(chunk_shape, max_cached_chunks, fill_value),
+                                             std::forward<S>(shape), std::forward<S>(chunk_shape));
+    }
+
+    template <class T, layout_type L, class S>
+    inline xchunked_array<xcompressed_chunk_store<T, L>>
+    chunked_compressed_array(std::initializer_list<S> shape, std::initializer_list<S> chunk_shape,
+                             std::size_t max_cached_chunks, const T& fill_value)
+    {
+        using sh_type = std::vector<std::size_t>;
+        auto sh = xtl::forward_sequence<sh_type, std::initializer_list<S>>(shape);
+        auto ch_sh = xtl::forward_sequence<sh_type, std::initializer_list<S>>(chunk_shape);
+        return chunked_compressed_array<T, L, sh_type>(std::move(sh), std::move(ch_sh), max_cached_chunks, fill_value);
+    }
+
+    template <layout_type L, class E, class S>
+    inline xchunked_array<xcompressed_chunk_store<typename E::value_type, L>>
+    chunked_compressed_array(const xexpression<E>& e, S&& chunk_shape, std::size_t max_cached_chunks)
+    {
+        using chunk_storage = xcompressed_chunk_store<typename E::value_type, L>;
+        return xchunked_array<chunk_storage>(e, chunk_storage(chunk_shape, max_cached_chunks),
+                                             std::forward<S>(chunk_shape));
+    }
+}
+
+#endif
@@ -26,6 +26,15 @@ namespace xt
     template <class chunk_storage>
     class xchunked_array;
 
+    template <class A, bool is_const>
+    class xchunked_stepper;
+
+    namespace detail
+    {
+        template <class CS>
+        struct has_stable_chunks;
+    }
+
     template <class chunk_storage>
     struct xcontainer_inner_types<xchunked_array<chunk_storage>>
     {
@@ -42,8 +51,12 @@ namespace xt
     {
         using chunk_type = typename chunk_storage::value_type;
         using inner_shape_type = typename chunk_type::shape_type;
-        using const_stepper = xindexed_stepper<xchunked_array<chunk_storage>, true>;
-        using stepper = xindexed_stepper<xchunked_array<chunk_storage>, false>;
+        using const_stepper = std::conditional_t<detail::has_stable_chunks<chunk_storage>::value,
+                                                 xchunked_stepper<xchunked_array<chunk_storage>, true>,
+                                                 xindexed_stepper<xchunked_array<chunk_storage>, true>>;
+        using stepper = std::conditional_t<detail::has_stable_chunks<chunk_storage>::value,
+                                           xchunked_stepper<xchunked_array<chunk_storage>, false>,
+                                           xindexed_stepper<xchunked_array<chunk_storage>, false>>;
     };
 
     template <class chunk_storage>
@@ -178,7 +191,76 @@ namespace xt
 
         shape_type m_shape;
         shape_type m_chunk_shape;
+        // log2 of the chunk shape, used when all its extents are powers of two
+        shape_type m_chunk_shift;
+        bool m_pow2_chunk_shape;
         chunk_storage_type m_chunks;
+
+        template <class A, bool is_const>
+        friend class xchunked_stepper;
+    };
+
+    /**
+     * @class xchunked_stepper
+     * @brief Stepper over the elements of a chunked array whose chunks are
+     * held in a plain container.
+     *
+     * The stepper keeps a pointer to the current chunk and the offset of the
+     * current element in it, so that stepping only looks up the chunk
+     * container when crossing a chunk boundary.
+     */
+    template <class A, bool is_const>
+    class xchunked_stepper
+    {
+    public:
+
+        using self_type = xchunked_stepper<A, is_const>;
+        using xexpression_type = std::conditional_t<is_const, const A, A>;
+        using chunk_type = std::conditional_t<is_const, const typename A::chunk_type, typename A::chunk_type>;
+
+        using value_type = typename xexpression_type::value_type;
+        using reference = std::conditional_t<is_const,
+                                             typename xexpression_type::const_reference,
+                                             typename xexpression_type::reference>;
+        using pointer = std::conditional_t<is_const,
+                                           typename xexpression_type::const_pointer,
+                                           typename xexpression_type::pointer>;
+        using size_type = typename xexpression_type::size_type;
+        using difference_type = typename xexpression_type::difference_type;
+
+        using shape_type = typename xexpression_type::shape_type;
+        using index_type = xindex_type_t<shape_type>;
+
+        xchunked_stepper() = default;
+        xchunked_stepper(xexpression_type* e, size_type offset, bool end = false);
+
+        reference operator*() const;
+
+        void step(size_type dim, size_type n = 1);
+        void step_back(size_type dim, size_type n = 1);
+        void reset(size_type dim);
+        void reset_back(size_type dim);
+
+        void to_begin();
+        void to_end(layout_type l);
+
+    private:
+
+        void move_to(size_type dim, size_type i);
+        void update_chunk();
+
+        xexpression_type* p_e;
+        chunk_type* p_chunk;
+        index_type m_index;
+        index_type m_chunk_index;
+        difference_type m_chunk_offset;
+        size_type m_offset;
+    };
+
+    template <class A, bool is_const>
+    struct is_indexed_stepper<xchunked_stepper<A, is_const>>
+    {
+        static const bool value = true;
     };
 
     template<class E>
@@ -285,6 +367,16 @@ namespace xt
 
         template <class E>
         using chunk_helper = chunk_helper_impl<E, try_chunk_shape>;
+
+        /**
+         * Whether the chunks of CS are held in a plain container, whose
+         * chunks can be referenced until the chunked array is resized (as
+         * opposed to chunk stores, which expose their chunk shape).
+         */
+        template <class CS>
+        struct has_stable_chunks : xtl::negation<typename chunk_helper<CS>::is_chunked>
+        {
+        };
     }
 
     template<class E>
@@ -568,6 +660,21 @@ namespace xt
 
         m_shape = xtl::forward_sequence<shape_type, S1>(shape);
         m_chunk_shape = xtl::forward_sequence<shape_type, S2>(chunk_shape);
+
+        // chunk extents that are powers of two allow shifts and masks instead of divisions
+        m_chunk_shift = m_chunk_shape;
+        m_pow2_chunk_shape = true;
+        for (std::size_t i = 0; i < m_chunk_shape.size(); ++i)
+        {
+            std::size_t cs = m_chunk_shape[i];
+            m_pow2_chunk_shape = m_pow2_chunk_shape && cs != 0 && (cs & (cs - 1)) == 0;
+            std::size_t shift = 0;
+            while ((std::size_t(1) << shift) < cs)
+            {
+                ++shift;
+            }
+            m_chunk_shift[i] = shift;
+        }
     }
 
     template <class CS>
@@ -582,6 +689,11 @@ namespace xt
     template <class Idx>
     inline std::pair<std::size_t, std::size_t> xchunked_array<CS>::get_chunk_indexes_in_dimension(std::size_t dim, Idx idx) const
     {
+        if (m_pow2_chunk_shape)
+        {
+            return std::make_pair(static_cast<size_t>(idx) >> m_chunk_shift[dim],
+                                  static_cast<size_t>(idx) & (m_chunk_shape[dim] - 1));
+        }
         std::size_t index_of_chunk = static_cast<size_t>(idx) / m_chunk_shape[dim];
         std::size_t index_in_chunk = static_cast<size_t>(idx) - index_of_chunk * m_chunk_shape[dim];
         return std::make_pair(index_of_chunk, index_in_chunk);
@@ -625,6 +737,142 @@ namespace xt
         }
         return std::make_pair(indexes_of_chunk, indexes_in_chunk);
     }
+
+    /***********************************
+     * xchunked_stepper implementation *
+     ***********************************/
+
+    template <class A, bool is_const>
+    inline xchunked_stepper<A, is_const>::xchunked_stepper(xexpression_type* e, size_type offset, bool end)
+        : p_e(e)
+        , p_chunk(nullptr)
+        , m_index(xtl::make_sequence<index_type>(e->shape().size(), size_type(0)))
+        , m_chunk_index(xtl::make_sequence<index_type>(e->shape().size(), size_type(0)))
+        , m_chunk_offset(0)
+        , m_offset(offset)
+    {
+        if (end)
+        {
+            to_end(XTENSOR_DEFAULT_TRAVERSAL);
+        }
+        else
+        {
+            update_chunk();
+        }
+    }
+
+    template <class A, bool is_const>
+    inline auto xchunked_stepper<A, is_const>::operator*() const -> reference
+    {
+        return p_chunk->data()[m_chunk_offset];
+    }
+
+    template <class A, bool is_const>
+    inline void xchunked_stepper<A, is_const>::step(size_type dim, size_type n)
+    {
+        if (dim >= m_offset)
+        {
+            move_to(dim - m_offset, m_index[dim - m_offset] + n);
+        }
+    }
+
+    template <class A, bool is_const>
+    inline void xchunked_stepper<A, is_const>::step_back(size_type dim, size_type n)
+    {
+        if (dim >= m_offset)
+        {
+            move_to(dim - m_offset, m_index[dim - m_offset] - n);
+        }
+    }
+
+    template <class A, bool is_const>
+    inline void xchunked_stepper<A, is_const>::reset(size_type dim)
+    {
+        if (dim >= m_offset)
+        {
+            move_to(dim - m_offset, 0);
+        }
+    }
+
+    template <class A, bool is_const>
+    inline void xchunked_stepper<A, is_const>::reset_back(size_type dim)
+    {
+        if (dim >= m_offset)
+        {
+            move_to(dim - m_offset, p_e->shape()[dim - m_offset] - 1);
+        }
+    }
+
+    template <class A, bool is_const>
+    inline void xchunked_stepper<A, is_const>::to_begin()
+    {
+        std::fill(m_index.begin(), m_index.end(), size_type(0));
+        update_chunk();
+    }
+
+    template <class A, bool is_const>
+    inline void xchunked_stepper<A, is_const>::to_end(layout_type l)
+    {
+        // Same position as the end index of xiterator, so that stepping back
+        // along the leading dimension lands on the last element
+        const auto& shape = p_e->shape();
+        std::transform(shape.cbegin(), shape.cend(), m_index.begin(), [](const auto& v) { return v - 1; });
+        if (!m_index.empty())
+        {
+            if (l == layout_type::row_major)
+            {
+                m_index.back() = shape.back();
+            }
+            else if (m_offset == 0)
+            {
+                m_index.front() = shape.front();
+            }
+        }
+        p_chunk = nullptr;
+    }
+
+    template <class A, bool is_const>
+    inline void xchunked_stepper<A, is_const>::move_to(size_type dim, size_type i)
+    {
+        if (p_chunk != nullptr && i < p_e->shape()[dim]
+            && p_e->get_chunk_indexes_in_dimension(dim, i).first == m_chunk_index[dim])
+        {
+            // still in the current chunk
+            m_chunk_offset += (static_cast<difference_type>(i) - static_cast<difference_type>(m_index[dim]))
+                              * static_cast<difference_type>(p_chunk->strides()[dim]);
+            m_index[dim] = i;
+        }
+        else
+        {
+            m_index[dim] = i;
+            update_chunk();
+        }
+    }
+
+    template <class A, bool is_const>
+    inline void xchunked_stepper<A, is_const>::update_chunk()
+    {
+        const auto& shape = p_e->shape();
+        for (size_type d = 0; d < m_index.size(); ++d)
+        {
+            if (m_index[d] >= shape[d])
+            {
+                // past the end in this dimension
+                p_chunk = nullptr;
+                return;
+            }
+            m_chunk_index[d] = p_e->get_chunk_indexes_in_dimension(d, m_index[d]).first;
+        }
+
+        p_chunk = &(p_e->chunks().element(m_chunk_index.cbegin(), m_chunk_index.cend()));
+        m_chunk_offset = 0;
+        for (size_type d = 0; d < m_index.size(); ++d)
+        {
+            size_type index_in_chunk = m_index[d] - m_chunk_index[d] * p_e->chunk_shape()[d];
+            m_chunk_offset += static_cast<difference_type>(index_in_chunk)
+                              * static_cast<difference_type>(p_chunk->strides()[d]);
+        }
+    }
 }
 
 #endif
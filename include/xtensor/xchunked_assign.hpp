@@ -10,8 +10,13 @@
 #ifndef XTENSOR_CHUNKED_ASSIGN_HPP
 #define XTENSOR_CHUNKED_ASSIGN_HPP
 
+#include <algorithm>
+#include <exception>
+#include <vector>
+
 #include "xnoalias.hpp"
 #include "xstrided_view.hpp"
+#include "xutils.hpp"
 
 namespace xt
 {
@@ -83,6 +88,9 @@ namespace xt
     template <class E>
     class xchunked_view;
 
+    template <class CT, class S, layout_type L, class FST>
+    class xdynamic_view;
+
     namespace detail
     {
         template <class T>
@@ -105,6 +113,124 @@ namespace xt
         {
         };
 
+        /**
+         * Whether distinct chunks of a chunk storage can be accessed concurrently;
+         * storages that load chunks on demand specialize it to false.
+         */
+        template <class CS>
+        struct is_concurrent_chunk_storage : std::true_type
+        {
+        };
+
+        template <template <class> class P, class E>
+        struct any_expression_node;
+
+        template <template <class> class P, class E>
+        struct any_expression_argument : std::false_type
+        {
+        };
+
+        template <template <class> class P, template <class...> class C, class... A>
+        struct any_expression_argument<P, C<A...>>
+            : xtl::disjunction<any_expression_node<P, std::decay_t<A>>...>
+        {
+        };
+
+        // The views with a layout_type parameter are not matched by C<A...>
+
+        template <template <class> class P, class CT, class S, layout_type L, class FST>
+        struct any_expression_argument<P, xstrided_view<CT, S, L, FST>>
+            : any_expression_node<P, std::decay_t<CT>>
+        {
+        };
+
+        template <template <class> class P, class CT, class S, layout_type L, class FST>
+        struct any_expression_argument<P, xdynamic_view<CT, S, L, FST>>
+            : any_expression_node<P, std::decay_t<CT>>
+        {
+        };
+
+        /**
+         * Whether the predicate P holds for the expression E or for one of the
+         * expressions it involves. Template arguments of E are inspected
+         * recursively.
+         */
+        template <template <class> class P, class E>
+        struct any_expression_node
+            : xtl::disjunction<P<E>, any_expression_argument<P, E>>
+        {
+        };
+
+        template <class E>
+        struct is_serial_chunked_array : std::false_type
+        {
+        };
+
+        template <class CS>
+        struct is_serial_chunked_array<xchunked_array<CS>>
+            : xtl::negation<is_concurrent_chunk_storage<CS>>
+        {
+        };
+
+        /**
+         * Whether the expression E involves chunked arrays whose chunks cannot be
+         * accessed concurrently.
+         */
+        template <class E>
+        using has_serial_chunk_storage = any_expression_node<is_serial_chunked_array, E>;
+
+        template <class CS>
+        using try_chunk_written = decltype(std::declval<CS&>().chunk_written(std::size_t(0)));
+
+        /**
+         * Notifies the chunk storage that a chunk has just been assigned, for
+         * storages that provide a chunk_written method.
+         */
+        template <class CS, class = void>
+        struct chunk_written_helper
+        {
+            static void notify(CS&, std::size_t)
+            {
+            }
+        };
+
+        template <class CS>
+        struct chunk_written_helper<CS, void_t<try_chunk_written<CS>>>
+        {
+            static void notify(CS& chunks, std::size_t i)
+            {
+                chunks.chunk_written(i);
+            }
+        };
+
+        template <class CS>
+        using try_prefetch_depth = decltype(std::declval<const CS&>().prefetch_depth());
+
+        /**
+         * Requests the background loading of the chunks following the chunk of
+         * linear index i, for storages that support prefetching.
+         */
+        template <class CS, class = void>
+        struct chunk_prefetch_helper
+        {
+            static void prefetch_after(const CS&, std::size_t)
+            {
+            }
+        };
+
+        template <class CS>
+        struct chunk_prefetch_helper<CS, void_t<try_prefetch_depth<CS>>>
+        {
+            static void prefetch_after(const CS& chunks, std::size_t i)
+            {
+                std::size_t last = (std::min)(i + 1 + chunks.prefetch_depth(), chunks.size());
+                for (std::size_t j = i + 1; j < last; ++j)
+                {
+                    chunks.prefetch(j);
+                }
+            }
+        };
+
         struct invalid_chunk_iterator {};
 
         template <class A>
@@ -115,6 +241,8 @@ namespace xt
             inline decltype(auto) get_chunk(A& arr, typename A::size_type i, const xstrided_slice_vector&) const
             {
                 using difference_type = typename A::difference_type;
+                using storage_type = std::decay_t<decltype(arr.chunks())>;
+                chunk_prefetch_helper<storage_type>::prefetch_after(arr.chunks(), i);
                 return *(arr.chunks().begin() + static_cast<difference_type>(i));
             }
         };
@@ -185,6 +313,17 @@ namespace xt
         xstrided_slice_vector m_slice_vector;
     };
 
+    namespace detail
+    {
+        /**
+         * Calls f(it, i) for the chunk iterator it of every chunk i of the chunked
+         * expression c. If parallel is true and TBB or OpenMP is enabled, ranges
+         * of chunks are processed concurrently, each one with its own iterator.
+         */
+        template <class C, class F>
+        void for_each_chunk(C& c, bool parallel, F&& f);
+    }
+
     /************************************
      * xchunked_semantic implementation *
      ************************************/
@@ -197,16 +336,75 @@ namespace xt
         dst = std::move(tmp);
     }
 
+    namespace detail
+    {
+        template <class C, class F>
+        inline void for_each_chunk(C& c, bool parallel, F&& f)
+        {
+            using iterator_type = decltype(c.chunk_begin());
+            using shape_type = typename std::decay_t<C>::shape_type;
+
+            std::size_t n_chunks = c.grid_size();
+            std::size_t n_blocks = parallel ? parallel_block_count(n_chunks, 1) : std::size_t(1);
+            if (n_blocks <= 1)
+            {
+                std::size_t i = 0;
+                auto it_end = c.chunk_end();
+                for (auto it = c.chunk_begin(); it != it_end; ++it, ++i)
+                {
+                    f(it, i);
+                }
+                return;
+            }
+
+            std::vector<std::exception_ptr> errors(n_blocks);
+            parallel_for_blocks(n_blocks, n_chunks, [&](std::size_t b, std::size_t begin, std::size_t end) {
+                try
+                {
+                    // index of the first chunk of the range in the grid
+                    shape_type chunk_index(c.dimension());
+                    std::size_t linear_index = begin;
+                    for (std::size_t d = chunk_index.size(); d != 0; --d)
+                    {
+                        chunk_index[d - 1] = linear_index % c.grid_shape()[d - 1];
+                        linear_index /= c.grid_shape()[d - 1];
+                    }
+                    iterator_type it(c, std::move(chunk_index), begin);
+                    for (std::size_t i = begin; i != end; ++i, ++it)
+                    {
+                        f(it, i);
+                    }
+                }
+                catch (...)
+                {
+                    errors[b] = std::current_exception();
+                }
+            });
+            for (const auto& error : errors)
+            {
+                if (error)
+                {
+                    std::rethrow_exception(error);
+                }
+            }
+        }
+    }
+
+    /**
+     * Assigns the expression chunk by chunk; chunks are assigned in parallel
+     * when TBB or OpenMP is enabled, unless the chunks of the array or of the
+     * expression are loaded on demand.
+     */
     template <class D>
     template <class E>
     inline auto xchunked_semantic<D>::assign_xexpression(const xexpression<E>& e) -> derived_type&
     {
         auto& d = this->derived_cast();
         const auto& chunk_shape = d.chunk_shape();
-        size_t i = 0;
-        auto it_end = d.chunk_end();
-        for (auto it = d.chunk_begin(); it != it_end; ++it, ++i)
-        {
+        constexpr bool parallel = !detail::has_serial_chunk_storage<D>::value
+                               && !detail::has_serial_chunk_storage<std::decay_t<E>>::value;
+        using chunk_storage_type = std::decay_t<decltype(d.chunks())>;
+        detail::for_each_chunk(d, parallel, [&d, &e, &chunk_shape](auto& it, std::size_t i) {
             auto rhs = strided_view(e.derived_cast(), it.get_slice_vector());
             if (rhs.shape() != chunk_shape)
             {
@@ -216,7 +414,8 @@ namespace xt
             {
                 noalias(*it) = rhs;
             }
-        }
+            detail::chunk_written_helper<chunk_storage_type>::notify(d.chunks(), i);
+        });
 
         return this->derived_cast();
     }
@@ -241,11 +440,14 @@ namespace xt
     template <class E, class F>
     inline auto xchunked_semantic<D>::scalar_computed_assign(const E& e, F&& f) -> derived_type&
     {
-        for (auto& c: this->derived_cast().chunks())
-        {
-            c.scalar_computed_assign(e, f);
-        }
-        return this->derived_cast();
+        auto& d = this->derived_cast();
+        constexpr bool parallel = !detail::has_serial_chunk_storage<D>::value;
+        using chunk_storage_type = std::decay_t<decltype(d.chunks())>;
+        detail::for_each_chunk(d, parallel, [&d, &e, &f](auto& it, std::size_t i) {
+            (*it).scalar_computed_assign(e, f);
+            detail::chunk_written_helper<chunk_storage_type>::notify(d.chunks(), i);
+        });
+        return d;
     }
 
     template <class D>
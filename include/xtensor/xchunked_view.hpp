@@ -83,6 +83,13 @@ namespace xt
 
     private:
 
+        // chunks are assigned in parallel unless they are loaded on demand or
+        // share bytes, as the elements of std::vector<bool> may
+        template <class OE>
+        using concurrent_assign = xtl::conjunction<xtl::negation<detail::has_serial_chunk_storage<self_type>>,
+                                                   xtl::negation<detail::has_serial_chunk_storage<OE>>,
+                                                   xtl::negation<std::is_same<value_type, bool>>>;
+
         E m_expression;
         shape_type m_shape;
         shape_type m_chunk_shape;
@@ -146,12 +153,11 @@ namespace xt
     template <class OE>
     typename std::enable_if_t<!is_chunked_t<OE>::value, xchunked_view<E>&> xchunked_view<E>::operator=(const OE& e)
     {
-        auto end = chunk_end();
-        for (auto it = chunk_begin(); it != end; ++it)
-        {
+        constexpr bool parallel = concurrent_assign<OE>::value;
+        detail::for_each_chunk(*this, parallel, [&e](auto& it, std::size_t) {
             auto el = *it;
             noalias(el) = strided_view(e, it.get_slice_vector());
-        }
+        });
         return *this;
     }
 
@@ -163,12 +169,10 @@ namespace xt
         const auto& cs = e.chunk_shape();
         std::copy(cs.cbegin(), cs.cend(), m_chunk_shape.begin());
         init();
-        auto it2 = e.chunks().begin();
-        auto end1 = chunk_end();
-        for (auto it1 = chunk_begin(); it1 != end1; ++it1, ++it2)
-        {
+        constexpr bool parallel = concurrent_assign<OE>::value;
+        detail::for_each_chunk(*this, parallel, [&e](auto& it1, std::size_t i) {
             auto el1 = *it1;
-            auto el2 = *it2;
+            auto el2 = *(e.chunks().begin() + static_cast<difference_type>(i));
             auto lhs_shape = el1.shape();
             if (lhs_shape != el2.shape())
             {
@@ -181,7 +185,7 @@ namespace xt
             {
                 noalias(el1) = el2;
             }
-        }
+        });
         return *this;
     }
 
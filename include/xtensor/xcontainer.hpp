@@ -283,6 +283,8 @@ namespace xt
         void resize(S&& shape, layout_type l);
         template <class S = shape_type>
         void resize(S&& shape, const strides_type& strides);
+        template <class S = shape_type>
+        void resize(S&& shape, layout_type l, uninitialized_t);
 
         template <class S = shape_type>
         auto& reshape(S&& shape, layout_type layout = base_type::static_layout) &;
@@ -325,6 +327,9 @@ namespace xt
 
     private:
 
+        template <class S, class... Tag>
+        void resize_impl(S&& shape, bool force, Tag... tag);
+
         inner_shape_type m_shape;
         inner_strides_type m_strides;
         inner_backstrides_type m_backstrides;
@@ -416,14 +421,15 @@ namespace xt
     //@{
 
     /**
-     * Fills the container with the given value.
+     * Fills the container with the given value, in parallel when TBB or
+     * OpenMP is enabled.
      * @param value the value to fill the container with.
      */
     template <class D>
     template <class T>
     inline void xcontainer<D>::fill(const T& value)
     {
-        std::fill(storage_begin(), storage_end(), value);
+        detail::parallel_fill(storage_begin(), storage_end(), value);
     }
 
     /**
@@ -916,6 +922,31 @@ namespace xt
             XTENSOR_ASSERT_MSG(c.size() == size, "Trying to resize const data container with wrong size.");
         }
 
+        template <class C, class S, class = void>
+        struct uninitialized_resizer
+        {
+            static void run(C& c, S size)
+            {
+                resize_data_container(c, size);
+            }
+        };
+
+        template <class C, class S>
+        struct uninitialized_resizer<C, S, void_t<decltype(std::declval<C&>().resize(std::declval<S>(), uninitialized))>>
+        {
+            static void run(C& c, S size)
+            {
+                c.resize(size, uninitialized);
+            }
+        };
+
+        // Data containers without an uninitialized resize are resized as usual
+        template <class C, class S>
+        inline void resize_data_container(C& c, S size, uninitialized_t)
+        {
+            uninitialized_resizer<C, S>::run(c, size);
+        }
+
         template <class S, class T>
         constexpr bool check_resize_dimension(const S&, const T&)
         {
@@ -939,6 +970,13 @@ namespace xt
     template <class D>
     template <class S>
     inline void xstrided_container<D>::resize(S&& shape, bool force)
+    {
+        resize_impl(std::forward<S>(shape), force);
+    }
+
+    template <class D>
+    template <class S, class... Tag>
+    inline void xstrided_container<D>::resize_impl(S&& shape, bool force, Tag... tag)
     {
         XTENSOR_ASSERT_MSG(detail::check_resize_dimension(m_shape, shape),
                            "cannot change the number of dimensions of xtensor")
@@ -954,7 +992,7 @@ namespace xt
             resize_container(m_strides, dim);
             resize_container(m_backstrides, dim);
             size_type data_size = compute_strides<D::static_layout>(m_shape, m_layout, m_strides, m_backstrides);
-            detail::resize_data_container(this->storage(), data_size);
+            detail::resize_data_container(this->storage(), data_size, tag...);
         }
     }
 
@@ -1005,6 +1043,28 @@ namespace xt
         detail::resize_data_container(this->storage(), compute_size(m_shape));
     }
 
+    /**
+     * Resizes the container, leaving its elements uninitialized for trivially
+     * default constructible types when the data container supports it.
+     * Elements of other types are value-initialized, in parallel when TBB or
+     * OpenMP is enabled.
+     * @param shape the new shape
+     * @param l the new layout_type
+     */
+    template <class D>
+    template <class S>
+    inline void xstrided_container<D>::resize(S&& shape, layout_type l, uninitialized_t)
+    {
+        XTENSOR_ASSERT_MSG(detail::check_resize_dimension(m_shape, shape),
+                           "cannot change the number of dimensions of xtensor")
+        if (base_type::static_layout != layout_type::dynamic && l != base_type::static_layout)
+        {
+            XTENSOR_THROW(std::runtime_error, "Cannot change layout_type if template parameter not layout_type::dynamic.");
+        }
+        m_layout = l;
+        resize_impl(std::forward<S>(shape), true, uninitialized);
+    }
+
     /**
      * Reshapes the container and keeps old elements. The `shape` argument can have one of its value
      * equal to `-1`, in this case the value is inferred from the number of elements in the container
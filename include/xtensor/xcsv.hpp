@@ -10,15 +10,41 @@
 #ifndef XTENSOR_CSV_HPP
 #define XTENSOR_CSV_HPP
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <exception>
+#include <initializer_list>
 #include <istream>
 #include <iterator>
+#include <limits>
+#include <locale>
+#include <numeric>
 #include <sstream>
 #include <string>
+#include <tuple>
 #include <utility>
+#include <vector>
+
+#if defined(__has_include)
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#include <charconv>
+#define XTENSOR_CSV_CHARCONV 1
+#else
+#define XTENSOR_CSV_CHARCONV 0
+#endif
 
 #include "xtensor.hpp"
 #include "xtensor_config.hpp"
+#include "xutils.hpp"
 
 namespace xt
 {
@@ -30,11 +56,54 @@ namespace xt
     template <class T, class A = std::allocator<T>>
     using xcsv_tensor = xtensor_container<std::vector<T, A>, 2, layout_type::row_major>;
 
+    template <class T>
+    using xcsv_column = xtensor_container<std::vector<T>, 1, layout_type::row_major>;
+
+    /**
+     * Columns loaded by load_csv_select and load_csv_columns, selected either
+     * by index or by name. Selecting by name requires the first data line
+     * (after the skipped rows) to be a header holding the column names.
+     */
+    struct xcsv_columns
+    {
+        xcsv_columns(std::initializer_list<std::size_t> column_indices);
+        xcsv_columns(std::initializer_list<std::string> column_names);
+        xcsv_columns(std::vector<std::size_t> column_indices);
+        xcsv_columns(std::vector<std::string> column_names);
+
+        std::size_t size() const;
+
+        std::vector<std::size_t> indices;
+        std::vector<std::string> names;
+    };
+
     template <class T, class A = std::allocator<T>>
     xcsv_tensor<T, A> load_csv(std::istream& stream, const char delimiter = ',', const std::size_t skip_rows = 0, const std::ptrdiff_t max_rows = -1, const std::string comments = "#");
 
+    template <class T, class A = std::allocator<T>>
+    xcsv_tensor<T, A> load_csv_select(std::istream& stream, const xcsv_columns& columns, const char delimiter = ',', const std::size_t skip_rows = 0, const std::ptrdiff_t max_rows = -1, const std::string comments = "#");
+
+    template <class... T>
+    std::tuple<xcsv_column<T>...> load_csv_columns(std::istream& stream, const xcsv_columns& columns, const char delimiter = ',', const std::size_t skip_rows = 0, const std::ptrdiff_t max_rows = -1, const std::string comments = "#");
+
+    /**
+     * Notation used by dump_csv for floating point values: the precision
+     * and flags of the output stream, as with operator<<, the shortest
+     * representation that reads back to the same value, or the fixed,
+     * scientific and general notations of printf with a given precision.
+     */
+    enum class csv_float_format
+    {
+        stream,
+        shortest,
+        fixed,
+        scientific,
+        general
+    };
+
     template <class E>
-    void dump_csv(std::ostream& stream, const xexpression<E>& e);
+    void dump_csv(std::ostream& stream, const xexpression<E>& e, const char delimiter = ',',
+                  const csv_float_format format = csv_float_format::stream, const int precision = 6);
 
     /*****************************************
      * load_csv and dump_csv implementations *
@@ -89,19 +158,1064 @@ namespace xt
         template <>
         inline unsigned long long lexical_cast<unsigned long long>(const std::string& cell) { return std::stoull(cell); }
 
-        template <class ST, class T, class OI>
-        ST load_csv_row(std::istream& row_stream, OI output, std::string cell, const char delimiter = ',')
+        // Size of the first block read from the stream, doubled after each
+        // block up to csv_block_size
+        constexpr std::size_t csv_initial_block_size = std::size_t(1) << 16;
+        constexpr std::size_t csv_block_size = std::size_t(1) << 24;
+        // Minimal number of bytes handled by a parallel chunk
+        constexpr std::size_t csv_grain_size = std::size_t(1) << 20;
+
+        inline const char* csv_skip_spaces(const char* first, const char* last)
+        {
+            while (first != last && (*first == ' ' || *first == '\t'))
+            {
+                ++first;
+            }
+            return first;
+        }
+
+        inline bool csv_is_digit(char c)
+        {
+            return static_cast<unsigned>(c - '0') < 10u;
+        }
+
+        /*
+         * The csv_convert functions convert the cell [first, last) in place,
+         * without building a string, and follow the semantics of the std::sto*
+         * functions: leading spaces are skipped, trailing characters are ignored,
+         * std::invalid_argument is thrown if there is no number to convert and
+         * std::out_of_range if it is not representable.
+         */
+
+        template <class T>
+        using csv_is_integer = xtl::conjunction<std::is_integral<T>,
+                                                xtl::negation<std::is_same<T, bool>>,
+                                                std::integral_constant<bool, (sizeof(T) > 1)>>;
+
+        template <class T>
+        using csv_is_float = xtl::disjunction<std::is_same<T, float>, std::is_same<T, double>>;
+
+        template <class T>
+        inline std::enable_if_t<csv_is_integer<T>::value>
+        csv_convert(const char* first, const char* last, T& value)
+        {
+            using unsigned_type = std::make_unsigned_t<T>;
+
+            const char* p = csv_skip_spaces(first, last);
+            bool negative = false;
+            if (p != last && (*p == '-' || *p == '+'))
+            {
+                negative = *p == '-';
+                ++p;
+            }
+
+            auto max_magnitude = static_cast<unsigned_type>(std::numeric_limits<T>::max());
+            if (negative && std::is_signed<T>::value)
+            {
+                ++max_magnitude;
+            }
+
+            const char* digits = p;
+            unsigned_type magnitude = 0;
+            for (; p != last && csv_is_digit(*p); ++p)
+            {
+                auto d = static_cast<unsigned_type>(*p - '0');
+                if (magnitude > static_cast<unsigned_type>((max_magnitude - d) / 10u))
+                {
+                    XTENSOR_THROW(std::out_of_range, "csv: integer out of range");
+                }
+                magnitude = static_cast<unsigned_type>(magnitude * 10u + d);
+            }
+            if (p == digits)
+            {
+                XTENSOR_THROW(std::invalid_argument, "csv: invalid integer");
+            }
+            value = static_cast<T>(negative ? static_cast<unsigned_type>(unsigned_type(0) - magnitude) : magnitude);
+        }
+
+#if !XTENSOR_CSV_CHARCONV
+        template <class T>
+        inline T csv_pow10(int exponent)
+        {
+            static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                       1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+            return static_cast<T>(powers[exponent]);
+        }
+
+        /**
+         * Clinger's fast path: a decimal mantissa that is exactly representable in T,
+         * scaled by an exactly representable power of ten, gives the correctly rounded
+         * result with a single operation. Returns false when it does not apply,
+         * including when the cell holds more than a decimal number, e.g. "0x1p3".
+         */
+        template <class T>
+        inline bool csv_fast_float(const char* p, const char* last, T& value)
+        {
+            constexpr int max_digits = 19;
+            constexpr int max_exponent = std::is_same<T, float>::value ? 10 : 22;
+            constexpr std::uint64_t max_mantissa = std::uint64_t(1) << std::numeric_limits<T>::digits;
+
+            bool negative = false;
+            if (p != last && (*p == '-' || *p == '+'))
+            {
+                negative = *p == '-';
+                ++p;
+            }
+
+            std::uint64_t mantissa = 0;
+            int n_digits = 0;
+            int exponent = 0;
+            const char* digits = p;
+            for (; p != last && csv_is_digit(*p); ++p)
+            {
+                if (++n_digits > max_digits)
+                {
+                    return false;
+                }
+                mantissa = mantissa * 10 + static_cast<std::uint64_t>(*p - '0');
+            }
+            bool has_digits = p != digits;
+            if (p != last && *p == '.')
+            {
+                digits = ++p;
+                for (; p != last && csv_is_digit(*p); ++p)
+                {
+                    if (++n_digits > max_digits)
+                    {
+                        return false;
+                    }
+                    mantissa = mantissa * 10 + static_cast<std::uint64_t>(*p - '0');
+                    --exponent;
+                }
+                has_digits = has_digits || p != digits;
+            }
+            if (!has_digits)
+            {
+                return false;
+            }
+            if (p != last && (*p == 'e' || *p == 'E'))
+            {
+                const char* q = p + 1;
+                bool negative_exponent = false;
+                if (q != last && (*q == '-' || *q == '+'))
+                {
+                    negative_exponent = *q == '-';
+                    ++q;
+                }
+                const char* exponent_digits = q;
+                int e = 0;
+                for (; q != last && csv_is_digit(*q); ++q)
+                {
+                    e = e < 10000 ? e * 10 + (*q - '0') : e;
+                }
+                if (q != exponent_digits)
+                {
+                    exponent += negative_exponent ? -e : e;
+                    p = q;
+                }
+            }
+            if (csv_skip_spaces(p, last) != last)
+            {
+                return false;
+            }
+
+            if (mantissa == 0)
+            {
+                value = negative ? -T(0) : T(0);
+                return true;
+            }
+            if (mantissa > max_mantissa || exponent < -max_exponent || exponent > max_exponent)
+            {
+                return false;
+            }
+            auto v = static_cast<T>(mantissa);
+            v = exponent < 0 ? v / csv_pow10<T>(-exponent) : v * csv_pow10<T>(exponent);
+            value = negative ? -v : v;
+            return true;
+        }
+#endif
+
+        inline void csv_strto(const char* str, char** end, float& value)
+        {
+            value = std::strtof(str, end);
+        }
+
+        inline void csv_strto(const char* str, char** end, double& value)
+        {
+            value = std::strtod(str, end);
+        }
+
+        template <class T>
+        inline std::enable_if_t<csv_is_float<T>::value>
+        csv_convert(const char* first, const char* last, T& value)
+        {
+            const char* p = csv_skip_spaces(first, last);
+#if XTENSOR_CSV_CHARCONV
+            // unlike strtod, from_chars does not accept a leading '+'
+            if (p != last && *p == '+')
+            {
+                ++p;
+            }
+            auto res = std::from_chars(p, last, value);
+            if (res.ec == std::errc() && csv_skip_spaces(res.ptr, last) == last)
+            {
+                return;
+            }
+            if (res.ec == std::errc::result_out_of_range)
+            {
+                XTENSOR_THROW(std::out_of_range, "csv: number out of range");
+            }
+            // cells that are not a plain decimal number, e.g. "0x1p3"
+#else
+            if (csv_fast_float(p, last, value))
+            {
+                return;
+            }
+            // hard cases (long mantissas, large exponents, inf, nan and
+            // cells that are not a plain decimal number)
+#endif
+            std::string cell(p, last);
+            char* end;
+            errno = 0;
+            csv_strto(cell.c_str(), &end, value);
+            if (end == cell.c_str())
+            {
+                XTENSOR_THROW(std::invalid_argument, "csv: invalid number");
+            }
+            if (errno == ERANGE)
+            {
+                XTENSOR_THROW(std::out_of_range, "csv: number out of range");
+            }
+        }
+
+        template <class T>
+        inline std::enable_if_t<!csv_is_integer<T>::value && !csv_is_float<T>::value>
+        csv_convert(const char* first, const char* last, T& value)
+        {
+            value = lexical_cast<T>(std::string(first, last));
+        }
+
+        // Size of the text formatted by a block before it is written to the stream
+        constexpr std::size_t csv_dump_buffer_size = std::size_t(1) << 22;
+        // Minimal number of elements formatted by a parallel block
+        constexpr std::size_t csv_dump_grain_size = std::size_t(1) << 16;
+
+        /*
+         * The csv_format functions append the text of a value to a string;
+         * the stream the tensor is dumped to is only used by types without
+         * a dedicated formatting routine.
+         */
+
+        template <class T>
+        inline bool csv_is_negative(T value, std::true_type)
+        {
+            return value < T(0);
+        }
+
+        template <class T>
+        inline bool csv_is_negative(T, std::false_type)
+        {
+            return false;
+        }
+
+        template <class T>
+        inline void csv_format_stream(std::string& out, const T& value, const std::ostream& stream)
+        {
+            std::ostringstream oss;
+            oss.copyfmt(stream);
+            oss << value;
+            out.append(oss.str());
+        }
+
+        /**
+         * Replaces the stream notation with the notation of printf matching
+         * the precision and flags of the stream, unless the stream has flags
+         * or a locale that printf cannot reproduce. In that case, the stream
+         * notation is kept and the values are formatted by a copy of the stream.
+         */
+        inline void csv_stream_format(const std::ostream& stream, csv_float_format& format, int& precision)
+        {
+            if (format != csv_float_format::stream)
+            {
+                return;
+            }
+            const std::ios_base::fmtflags flags = stream.flags();
+            const std::ios_base::fmtflags unsupported = std::ios_base::showpos | std::ios_base::showpoint
+                                                      | std::ios_base::uppercase | std::ios_base::boolalpha
+                                                      | std::ios_base::showbase;
+            const std::ios_base::fmtflags base = flags & std::ios_base::basefield;
+            if ((flags & unsupported) || (base != std::ios_base::dec && base != std::ios_base::fmtflags(0))
+                || stream.getloc() != std::locale::classic())
+            {
+                return;
+            }
+            const std::ios_base::fmtflags notation = flags & std::ios_base::floatfield;
+            if (notation == std::ios_base::fixed)
+            {
+                format = csv_float_format::fixed;
+            }
+            else if (notation == std::ios_base::scientific)
+            {
+                format = csv_float_format::scientific;
+            }
+            else if (notation == std::ios_base::fmtflags(0))
+            {
+                format = csv_float_format::general;
+            }
+            else
+            {
+                // hexfloat
+                return;
+            }
+            precision = static_cast<int>(stream.precision());
+        }
+
+        template <class T>
+        inline std::enable_if_t<csv_is_integer<T>::value>
+        csv_format(std::string& out, const T& value, csv_float_format format, int, const std::ostream& stream)
+        {
+            if (format == csv_float_format::stream)
+            {
+                csv_format_stream(out, value, stream);
+                return;
+            }
+            using unsigned_type = std::make_unsigned_t<T>;
+            bool negative = csv_is_negative(value, std::is_signed<T>());
+            auto magnitude = static_cast<unsigned_type>(value);
+            if (negative)
+            {
+                magnitude = static_cast<unsigned_type>(unsigned_type(0) - magnitude);
+            }
+            char buffer[std::numeric_limits<unsigned_type>::digits10 + 2];
+            char* last = buffer + sizeof(buffer);
+            char* first = last;
+            do
+            {
+                *--first = static_cast<char>('0' + magnitude % 10u);
+                magnitude = static_cast<unsigned_type>(magnitude / 10u);
+            } while (magnitude != 0);
+            if (negative)
+            {
+                *--first = '-';
+            }
+            out.append(first, last);
+        }
+
+        inline void csv_format(std::string& out, bool value, csv_float_format format, int, const std::ostream& stream)
+        {
+            if (format == csv_float_format::stream)
+            {
+                csv_format_stream(out, value, stream);
+                return;
+            }
+            out.push_back(value ? '1' : '0');
+        }
+
+        inline void csv_format(std::string& out, const std::string& value, csv_float_format, int, const std::ostream&)
+        {
+            out.append(value);
+        }
+
+#if XTENSOR_CSV_CHARCONV
+        template <class T>
+        inline std::to_chars_result csv_to_chars(char* first, char* last, T value, csv_float_format format, int precision)
+        {
+            switch (format)
+            {
+                case csv_float_format::fixed:
+                    return std::to_chars(first, last, value, std::chars_format::fixed, precision);
+                case csv_float_format::scientific:
+                    return std::to_chars(first, last, value, std::chars_format::scientific, precision);
+                case csv_float_format::general:
+                    return std::to_chars(first, last, value, std::chars_format::general, precision);
+                default:
+                    return std::to_chars(first, last, value);
+            }
+        }
+#else
+        inline int csv_snprintf(char* buffer, std::size_t size, const char* format, int precision, float value)
+        {
+            return std::snprintf(buffer, size, format, precision, static_cast<double>(value));
+        }
+
+        inline int csv_snprintf(char* buffer, std::size_t size, const char* format, int precision, double value)
+        {
+            return std::snprintf(buffer, size, format, precision, value);
+        }
+
+        inline bool csv_round_trips(const char* text, float value)
+        {
+            return std::strtof(text, nullptr) == value;
+        }
+
+        inline bool csv_round_trips(const char* text, double value)
+        {
+            return std::strtod(text, nullptr) == value;
+        }
+#endif
+
+        template <class T>
+        inline std::enable_if_t<csv_is_float<T>::value>
+        csv_format(std::string& out, const T& value, csv_float_format format, int precision, const std::ostream& stream)
+        {
+            if (format == csv_float_format::stream)
+            {
+                csv_format_stream(out, value, stream);
+                return;
+            }
+            char buffer[64];
+#if XTENSOR_CSV_CHARCONV
+            auto res = csv_to_chars(buffer, buffer + sizeof(buffer), value, format, precision);
+            if (res.ec == std::errc())
+            {
+                out.append(buffer, res.ptr);
+                return;
+            }
+            // fixed notation of large values or large precisions
+            std::vector<char> large(static_cast<std::size_t>(std::numeric_limits<T>::max_exponent10 + precision + 8));
+            res = csv_to_chars(large.data(), large.data() + large.size(), value, format, precision);
+            out.append(large.data(), res.ptr);
+#else
+            int length = 0;
+            if (format == csv_float_format::shortest)
+            {
+                // the shortest precision that reads back to the same value
+                int p = std::numeric_limits<T>::digits10;
+                do
+                {
+                    length = csv_snprintf(buffer, sizeof(buffer), "%.*g", p, value);
+                } while (!csv_round_trips(buffer, value) && ++p <= std::numeric_limits<T>::max_digits10);
+            }
+            else
+            {
+                const char* notation = format == csv_float_format::fixed ? "%.*f"
+                                     : format == csv_float_format::scientific ? "%.*e" : "%.*g";
+                length = csv_snprintf(buffer, sizeof(buffer), notation, precision, value);
+                if (static_cast<std::size_t>(length) >= sizeof(buffer))
+                {
+                    std::vector<char> large(static_cast<std::size_t>(length) + 1);
+                    csv_snprintf(large.data(), large.size(), notation, precision, value);
+                    out.append(large.data(), static_cast<std::size_t>(length));
+                    return;
+                }
+            }
+            out.append(buffer, static_cast<std::size_t>(length));
+#endif
+        }
+
+        template <class T>
+        inline std::enable_if_t<!csv_is_integer<T>::value && !csv_is_float<T>::value>
+        csv_format(std::string& out, const T& value, csv_float_format, int, const std::ostream& stream)
+        {
+            csv_format_stream(out, value, stream);
+        }
+
+        // Formats the rows [first, last) of the 2-D expression e
+        template <class E>
+        inline void csv_format_rows(std::string& out, const E& e, std::size_t first, std::size_t last, char delimiter,
+                                    csv_float_format format, int precision, const std::ostream& stream)
+        {
+            using value_type = typename E::value_type;
+            using size_type = typename E::size_type;
+            size_type nbcols = e.shape()[1];
+            auto st = e.stepper_begin(e.shape());
+            st.step(0, static_cast<size_type>(first));
+            for (std::size_t r = first; r != last; ++r)
+            {
+                for (size_type c = 0; c != nbcols; ++c)
+                {
+                    const value_type& value = *st;
+                    csv_format(out, value, format, precision, stream);
+                    if (c != nbcols - 1)
+                    {
+                        st.step(1);
+                        out.push_back(delimiter);
+                    }
+                    else
+                    {
+                        st.reset(1);
+                        st.step(0);
+                        out.push_back('\n');
+                    }
+                }
+            }
+        }
+
+        // Returns the end of the line starting at first, excluding the line break
+        inline const char* csv_line_end(const char* first, const char* last, const char*& next)
+        {
+            auto nl = static_cast<const char*>(std::memchr(first, '\n', static_cast<std::size_t>(last - first)));
+            next = nl == nullptr ? last : nl + 1;
+            const char* end = nl == nullptr ? last : nl;
+            return end != first && end[-1] == '\r' ? end - 1 : end;
+        }
+
+        // Empty lines and comments hold no data
+        inline bool csv_is_data_line(const char* first, const char* last, const std::string& comments)
+        {
+            if (first == last)
+            {
+                return false;
+            }
+            return comments.empty() || static_cast<std::size_t>(last - first) < comments.size()
+                || !std::equal(comments.begin(), comments.end(), first);
+        }
+
+        // A trailing delimiter does not start a new cell
+        inline std::size_t csv_count_cells(const char* first, const char* last, char delimiter)
+        {
+            std::size_t n = 1;
+            const char* p = first;
+            while ((p = static_cast<const char*>(std::memchr(p, delimiter, static_cast<std::size_t>(last - p)))) != nullptr)
+            {
+                ++n;
+                ++p;
+            }
+            return last[-1] == delimiter ? n - 1 : n;
+        }
+
+        inline std::size_t csv_count_data_lines(const char* first, const char* last, const std::string& comments)
+        {
+            std::size_t n = 0;
+            while (first != last)
+            {
+                const char* next;
+                const char* end = csv_line_end(first, last, next);
+                if (csv_is_data_line(first, end, comments))
+                {
+                    ++n;
+                }
+                first = next;
+            }
+            return n;
+        }
+
+        /**
+         * Splits lines into cells and hands the cells of the selected columns to
+         * a callback, along with their position in the selection. Cells after the
+         * last selected column are neither scanned nor converted. Without
+         * selection, every line must have as many cells as the first one.
+         */
+        class csv_line_parser
+        {
+        public:
+
+            explicit csv_line_parser(char delimiter)
+                : m_delimiter(delimiter), m_size(0), m_selected(false)
+            {
+            }
+
+            void select(const std::vector<std::size_t>& columns)
+            {
+                m_columns.clear();
+                for (std::size_t i = 0; i < columns.size(); ++i)
+                {
+                    m_columns.emplace_back(columns[i], i);
+                }
+                std::sort(m_columns.begin(), m_columns.end());
+                m_size = columns.size();
+                m_selected = true;
+            }
+
+            bool initialized() const
+            {
+                return m_selected || m_size != 0;
+            }
+
+            void initialize(const char* first, const char* last)
+            {
+                m_size = csv_count_cells(first, last, m_delimiter);
+            }
+
+            std::size_t size() const
+            {
+                return m_size;
+            }
+
+            template <class F>
+            void parse(const char* first, const char* last, F&& store) const
+            {
+                if (m_selected)
+                {
+                    parse_selected(first, last, store);
+                }
+                else
+                {
+                    parse_all(first, last, store);
+                }
+            }
+
+        private:
+
+            const char* cell_end(const char* first, const char* last) const
+            {
+                auto p = static_cast<const char*>(std::memchr(first, m_delimiter, static_cast<std::size_t>(last - first)));
+                return p == nullptr ? last : p;
+            }
+
+            template <class F>
+            void parse_all(const char* first, const char* last, F& store) const
+            {
+                const char* p = first;
+                for (std::size_t c = 0; c < m_size; ++c)
+                {
+                    const char* q = cell_end(p, last);
+                    if (q == last && c + 1 != m_size)
+                    {
+                        XTENSOR_THROW(std::runtime_error, "Inconsistent row lengths in CSV");
+                    }
+                    store(c, p, q);
+                    p = q == last ? last : q + 1;
+                }
+                if (p != last)
+                {
+                    XTENSOR_THROW(std::runtime_error, "Inconsistent row lengths in CSV");
+                }
+            }
+
+            template <class F>
+            void parse_selected(const char* first, const char* last, F& store) const
+            {
+                std::size_t k = 0;
+                const char* p = first;
+                for (std::size_t c = 0; k != m_columns.size(); ++c)
+                {
+                    const char* q = cell_end(p, last);
+                    for (; k != m_columns.size() && m_columns[k].first == c; ++k)
+                    {
+                        store(m_columns[k].second, p, q);
+                    }
+                    if (q == last)
+                    {
+                        break;
+                    }
+                    p = q + 1;
+                }
+                if (k != m_columns.size())
+                {
+                    XTENSOR_THROW(std::runtime_error, "Missing selected column in CSV row");
+                }
+            }
+
+            char m_delimiter;
+            std::size_t m_size;
+            bool m_selected;
+            // (file column, selection position) pairs sorted by file column
+            std::vector<std::pair<std::size_t, std::size_t>> m_columns;
+        };
+
+        template <class V>
+        inline void csv_store(V& data, std::size_t i, const char* first, const char* last)
+        {
+            typename V::value_type value;
+            csv_convert(first, last, value);
+            data[i] = std::move(value);
+        }
+
+        /*
+         * Sinks receive the parsed cells: resize(n_rows, n_cols) appends n_rows
+         * rows and store(row, col, first, last) converts a cell of these rows.
+         * Distinct cells may be stored concurrently when parallel is true.
+         */
+
+        // Rows of a row-major 2-D tensor
+        template <class S>
+        class csv_tensor_sink
+        {
+        public:
+
+            static constexpr bool parallel = !std::is_same<typename S::value_type, bool>::value;
+
+            explicit csv_tensor_sink(S& data)
+                : m_data(data), m_n_cols(0), m_offset(0)
+            {
+            }
+
+            void resize(std::size_t n_rows, std::size_t n_cols)
+            {
+                m_n_cols = n_cols;
+                m_offset = m_data.size();
+                m_data.resize(m_offset + n_rows * n_cols);
+            }
+
+            void store(std::size_t row, std::size_t col, const char* first, const char* last)
+            {
+                csv_store(m_data, m_offset + row * m_n_cols + col, first, last);
+            }
+
+        private:
+
+            S& m_data;
+            std::size_t m_n_cols;
+            std::size_t m_offset;
+        };
+
+        // One 1-D container per column
+        template <class... T>
+        class csv_columns_sink
         {
-            ST length = 0;
-            while (std::getline(row_stream, cell, delimiter))
+        public:
+
+            static_assert(sizeof...(T) > 0, "at least one column must be loaded");
+
+            using data_type = std::tuple<std::vector<T>...>;
+
+            static constexpr bool parallel = !xtl::disjunction<std::is_same<T, bool>...>::value;
+
+            explicit csv_columns_sink(data_type& data)
+                : m_data(data), m_offset(0)
             {
-                *output++ = lexical_cast<T>(cell);
-                ++length;
             }
-            return length;
+
+            void resize(std::size_t n_rows, std::size_t)
+            {
+                m_offset = std::get<0>(m_data).size();
+                resize_impl(m_offset + n_rows, std::index_sequence_for<T...>());
+            }
+
+            void store(std::size_t row, std::size_t col, const char* first, const char* last)
+            {
+                store_impl(m_offset + row, col, first, last, std::index_sequence_for<T...>());
+            }
+
+        private:
+
+            template <std::size_t... I>
+            void resize_impl(std::size_t size, std::index_sequence<I...>)
+            {
+                using expander = int[];
+                (void) expander{0, (std::get<I>(m_data).resize(size), 0)...};
+            }
+
+            template <std::size_t... I>
+            void store_impl(std::size_t row, std::size_t col, const char* first, const char* last, std::index_sequence<I...>)
+            {
+                using expander = int[];
+                (void) expander{0, (col == I ? (csv_store(std::get<I>(m_data), row, first, last), 0) : 0)...};
+            }
+
+            data_type& m_data;
+            std::size_t m_offset;
+        };
+
+        /**
+         * Parses at most max_rows data lines of [first, last), which ends on a line
+         * boundary, into sink. The text is split into newline-aligned chunks; the
+         * data lines of each chunk are counted first, so that the sink is resized
+         * once per call and every chunk is parsed in parallel into its own rows. The parser
+         * is initialized from the first data line if needed. Returns the number of
+         * parsed rows.
+         */
+        template <class S>
+        inline std::size_t csv_parse_lines(const char* first, const char* last, const std::string& comments,
+                                           std::size_t max_rows, csv_line_parser& parser, S& sink)
+        {
+            std::size_t size = static_cast<std::size_t>(last - first);
+            // distinct elements of std::vector<bool> cannot be written concurrently
+            std::size_t n_chunks = S::parallel ? parallel_block_count(size, csv_grain_size) : std::size_t(1);
+
+            std::vector<const char*> bounds(n_chunks + 1, last);
+            bounds[0] = first;
+            for (std::size_t k = 1; k < n_chunks; ++k)
+            {
+                const char* p = (std::max)(first + size / n_chunks * k, bounds[k - 1]);
+                auto nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(last - p)));
+                bounds[k] = nl == nullptr ? last : nl + 1;
+            }
+
+            std::vector<std::size_t> rows(n_chunks + 1, 0);
+            parallel_for_blocks(n_chunks, n_chunks, [&](std::size_t k, std::size_t, std::size_t) {
+                rows[k + 1] = csv_count_data_lines(bounds[k], bounds[k + 1], comments);
+            });
+            std::partial_sum(rows.begin(), rows.end(), rows.begin());
+            std::size_t n_rows = (std::min)(rows.back(), max_rows);
+            if (n_rows == 0)
+            {
+                return 0;
+            }
+
+            if (!parser.initialized())
+            {
+                const char* p = first;
+                for (;;)
+                {
+                    const char* next;
+                    const char* end = csv_line_end(p, last, next);
+                    if (csv_is_data_line(p, end, comments))
+                    {
+                        parser.initialize(p, end);
+                        break;
+                    }
+                    p = next;
+                }
+            }
+
+            sink.resize(n_rows, parser.size());
+            std::vector<std::exception_ptr> errors(n_chunks);
+            parallel_for_blocks(n_chunks, n_chunks, [&](std::size_t k, std::size_t, std::size_t) {
+                try
+                {
+                    std::size_t row = rows[k];
+                    const char* p = bounds[k];
+                    while (p != bounds[k + 1] && row < n_rows)
+                    {
+                        const char* next;
+                        const char* end = csv_line_end(p, bounds[k + 1], next);
+                        if (csv_is_data_line(p, end, comments))
+                        {
+                            parser.parse(p, end, [&sink, row](std::size_t col, const char* cell_first, const char* cell_last) {
+                                sink.store(row, col, cell_first, cell_last);
+                            });
+                            ++row;
+                        }
+                        p = next;
+                    }
+                }
+                catch (...)
+                {
+                    errors[k] = std::current_exception();
+                }
+            });
+            for (const auto& error : errors)
+            {
+                if (error)
+                {
+                    std::rethrow_exception(error);
+                }
+            }
+            return n_rows;
+        }
+
+        // Positions of the selected names in the header line [first, last)
+        inline std::vector<std::size_t> csv_header_indices(const char* first, const char* last, char delimiter,
+                                                           const std::vector<std::string>& names)
+        {
+            std::vector<std::string> header;
+            const char* p = first;
+            for (;;)
+            {
+                auto q = static_cast<const char*>(std::memchr(p, delimiter, static_cast<std::size_t>(last - p)));
+                header.push_back(lexical_cast<std::string>(std::string(p, q == nullptr ? last : q)));
+                if (q == nullptr)
+                {
+                    break;
+                }
+                p = q + 1;
+            }
+
+            std::vector<std::size_t> indices;
+            for (const auto& name : names)
+            {
+                auto it = std::find(header.begin(), header.end(), name);
+                if (it == header.end())
+                {
+                    XTENSOR_THROW(std::runtime_error, "Column " + name + " not found in CSV header");
+                }
+                indices.push_back(static_cast<std::size_t>(it - header.begin()));
+            }
+            return indices;
+        }
+
+        /**
+         * Appends whole lines of the stream to the buffer, until n_lines lines
+         * have been read or the buffer holds at least size bytes, so that no
+         * character following the last line is extracted. Returns false at the
+         * end of the stream.
+         */
+        inline bool csv_read_lines(std::istream& stream, std::vector<char>& buffer, std::size_t& filled,
+                                   std::size_t n_lines, std::size_t size)
+        {
+            std::string line;
+            for (std::size_t i = 0; i < n_lines && filled < size; ++i)
+            {
+                if (!std::getline(stream, line))
+                {
+                    return false;
+                }
+                if (buffer.size() < filled + line.size() + 1)
+                {
+                    buffer.resize((std::max)(2 * buffer.size(), filled + line.size() + 1));
+                }
+                std::copy(line.cbegin(), line.cend(), buffer.begin() + static_cast<std::ptrdiff_t>(filled));
+                filled += line.size();
+                buffer[filled++] = '\n';
+            }
+            return !stream.eof();
+        }
+
+        /**
+         * Reads the stream by blocks of growing size, each of them being parsed
+         * up to its last line break; the incomplete last line is moved to the
+         * next block. If columns are selected by name, the first data line is
+         * the header. When max_rows is positive, the stream is read line by line
+         * and is left right after the last parsed row, so that the next rows can
+         * be loaded by another call. Returns the number of parsed rows.
+         */
+        template <class S>
+        inline std::size_t csv_load(std::istream& stream, const xcsv_columns* columns, S& sink, csv_line_parser& parser,
+                                    const char delimiter, const std::size_t skip_rows, const std::ptrdiff_t max_rows,
+                                    const std::string& comments)
+        {
+            std::size_t nbrow = 0, nhead = 0;
+            std::size_t max_nbrow = max_rows > 0 ? static_cast<std::size_t>(max_rows) : std::numeric_limits<std::size_t>::max();
+            bool header = columns != nullptr && !columns->names.empty();
+            if (columns != nullptr && !header)
+            {
+                parser.select(columns->indices);
+            }
+
+            std::vector<char> buffer(csv_initial_block_size);
+            std::size_t block_size = csv_initial_block_size;
+            std::size_t filled = 0;
+            bool eof = false;
+            while (!eof && nbrow < max_nbrow)
+            {
+                if (max_rows > 0)
+                {
+                    // every remaining row needs at least one line
+                    eof = !csv_read_lines(stream, buffer, filled, max_nbrow - nbrow, block_size);
+                }
+                else
+                {
+                    if (filled == buffer.size())
+                    {
+                        // the buffer holds a single incomplete line
+                        buffer.resize(2 * buffer.size());
+                    }
+                    auto requested = static_cast<std::streamsize>(buffer.size() - filled);
+                    std::streamsize count = stream.rdbuf()->sgetn(buffer.data() + filled, requested);
+                    filled += static_cast<std::size_t>(count);
+                    eof = count < requested;
+                    if (eof)
+                    {
+                        stream.setstate(std::ios_base::eofbit);
+                    }
+                }
+                block_size = (std::min)(2 * block_size, csv_block_size);
+
+                const char* first = buffer.data();
+                const char* last = first + filled;
+                const char* stop = last;
+                if (!eof)
+                {
+                    while (stop != first && stop[-1] != '\n')
+                    {
+                        --stop;
+                    }
+                    if (stop == first)
+                    {
+                        continue;
+                    }
+                }
+
+                while (nhead < skip_rows && first != stop)
+                {
+                    auto nl = static_cast<const char*>(std::memchr(first, '\n', static_cast<std::size_t>(stop - first)));
+                    first = nl == nullptr ? stop : nl + 1;
+                    ++nhead;
+                }
+
+                while (header && first != stop)
+                {
+                    const char* next;
+                    const char* end = csv_line_end(first, stop, next);
+                    if (csv_is_data_line(first, end, comments))
+                    {
+                        parser.select(csv_header_indices(first, end, delimiter, columns->names));
+                        header = false;
+                    }
+                    first = next;
+                }
+
+                nbrow += csv_parse_lines(first, stop, comments, max_nbrow - nbrow, parser, sink);
+
+                filled = static_cast<std::size_t>(last - stop);
+                std::memmove(buffer.data(), stop, filled);
+                if (max_rows <= 0 && buffer.size() < block_size)
+                {
+                    buffer.resize(block_size);
+                }
+            }
+            return nbrow;
+        }
+
+        template <class T, class A>
+        inline xcsv_tensor<T, A> load_csv_tensor(std::istream& stream, const xcsv_columns* columns, const char delimiter,
+                                                 const std::size_t skip_rows, const std::ptrdiff_t max_rows,
+                                                 const std::string& comments)
+        {
+            using tensor_type = xcsv_tensor<T, A>;
+            using storage_type = typename tensor_type::storage_type;
+            using size_type = typename tensor_type::size_type;
+            using inner_shape_type = typename tensor_type::inner_shape_type;
+            using inner_strides_type = typename tensor_type::inner_strides_type;
+
+            storage_type data;
+            csv_tensor_sink<storage_type> sink(data);
+            csv_line_parser parser(delimiter);
+            size_type nbrow = csv_load(stream, columns, sink, parser, delimiter, skip_rows, max_rows, comments);
+            size_type nbcol = nbrow == 0 ? size_type(0) : parser.size();
+
+            inner_shape_type shape = {nbrow, nbcol};
+            inner_strides_type strides;  // no need for initializer list for stack-allocated strides_type
+            size_type data_size = compute_strides(shape, layout_type::row_major, strides);
+            // Sanity check for data size.
+            if (data.size() != data_size)
+            {
+                XTENSOR_THROW(std::runtime_error, "Inconsistent row lengths in CSV");
+            }
+            return tensor_type(std::move(data), std::move(shape), std::move(strides));
+        }
+
+        template <class T>
+        inline xcsv_column<T> make_csv_column(std::vector<T>&& data)
+        {
+            using tensor_type = xcsv_column<T>;
+            using inner_shape_type = typename tensor_type::inner_shape_type;
+            using inner_strides_type = typename tensor_type::inner_strides_type;
+
+            inner_shape_type shape = {data.size()};
+            inner_strides_type strides;
+            compute_strides(shape, layout_type::row_major, strides);
+            return tensor_type(std::move(data), std::move(shape), std::move(strides));
+        }
+
+        template <class... T, std::size_t... I>
+        inline std::tuple<xcsv_column<T>...> make_csv_columns(std::tuple<std::vector<T>...>& data, std::index_sequence<I...>)
+        {
+            return std::tuple<xcsv_column<T>...>(make_csv_column(std::move(std::get<I>(data)))...);
         }
     }
 
+    /*******************************
+     * xcsv_columns implementation *
+     *******************************/
+
+    inline xcsv_columns::xcsv_columns(std::initializer_list<std::size_t> column_indices)
+        : indices(column_indices)
+    {
+    }
+
+    inline xcsv_columns::xcsv_columns(std::initializer_list<std::string> column_names)
+        : names(column_names)
+    {
+    }
+
+    inline xcsv_columns::xcsv_columns(std::vector<std::size_t> column_indices)
+        : indices(std::move(column_indices))
+    {
+    }
+
+    inline xcsv_columns::xcsv_columns(std::vector<std::string> column_names)
+        : names(std::move(column_names))
+    {
+    }
+
+    inline std::size_t xcsv_columns::size() const
+    {
+        return names.empty() ? indices.size() : names.size();
+    }
+
     /**
      * @brief Load tensor from CSV.
      * 
@@ -119,82 +1233,119 @@ namespace xt
                                const std::ptrdiff_t max_rows,
                                const std::string comments)
     {
-        using tensor_type = xcsv_tensor<T, A>;
-        using storage_type = typename tensor_type::storage_type;
-        using size_type = typename tensor_type::size_type;
-        using inner_shape_type = typename tensor_type::inner_shape_type;
-        using inner_strides_type = typename tensor_type::inner_strides_type;
-        using output_iterator = std::back_insert_iterator<storage_type>;
+        return detail::load_csv_tensor<T, A>(stream, nullptr, delimiter, skip_rows, max_rows, comments);
+    }
 
-        storage_type data;
-        size_type nbrow = 0, nbcol = 0, nhead = 0;
-        {
-            output_iterator output(data);
-            std::string row, cell;
-            while (std::getline(stream, row))
-            {
-                if (nhead < skip_rows) 
-                {
-                    ++nhead;
-                    continue;
-                }
-                if (std::equal(comments.begin(), comments.end(), row.begin()))
-                {
-                    continue;
-                }
-                if (0 < max_rows && max_rows <= static_cast<const long long>(nbrow))
-                {
-                    break;
-                }
-                std::stringstream row_stream(row);
-                nbcol = detail::load_csv_row<size_type, T, output_iterator>(row_stream, output, cell, delimiter);
-                ++nbrow;
-            }
-        }
-        inner_shape_type shape = {nbrow, nbcol};
-        inner_strides_type strides;  // no need for initializer list for stack-allocated strides_type
-        size_type data_size = compute_strides(shape, layout_type::row_major, strides);
-        // Sanity check for data size.
-        if (data.size() != data_size)
+    /**
+     * @brief Load selected columns of a CSV into a tensor.
+     *
+     * Cells of the other columns are not converted. Returns an \ref xexpression
+     * whose columns are the selected ones, in the order of the selection.
+     * @param stream the input stream containing the CSV encoded values
+     * @param columns the indices of the columns to load, or their names in the header line
+     * @param delimiter the character used to separate values. [default: ',']
+     * @param skip_rows the number of lines to skip from the beginning. [default: 0]
+     * @param max_rows the number of lines to read after skip_rows lines and the header; the default is to read all the lines. [default: -1]
+     * @param comments the string used to indicate the start of a comment. [default: "#"]
+     */
+    template <class T, class A>
+    xcsv_tensor<T, A> load_csv_select(std::istream& stream,
+                                      const xcsv_columns& columns,
+                                      const char delimiter,
+                                      const std::size_t skip_rows,
+                                      const std::ptrdiff_t max_rows,
+                                      const std::string comments)
+    {
+        return detail::load_csv_tensor<T, A>(stream, &columns, delimiter, skip_rows, max_rows, comments);
+    }
+
+    /**
+     * @brief Load selected columns of a CSV into 1-D tensors of different types.
+     *
+     * The I-th column of the selection is converted to the I-th type and the
+     * whole file is parsed in a single pass.
+     * @param stream the input stream containing the CSV encoded values
+     * @param columns the indices of the columns to load, or their names in the header line
+     * @param delimiter the character used to separate values. [default: ',']
+     * @param skip_rows the number of lines to skip from the beginning. [default: 0]
+     * @param max_rows the number of lines to read after skip_rows lines and the header; the default is to read all the lines. [default: -1]
+     * @param comments the string used to indicate the start of a comment. [default: "#"]
+     * @return a tuple holding one 1-D tensor per selected column
+     */
+    template <class... T>
+    std::tuple<xcsv_column<T>...> load_csv_columns(std::istream& stream,
+                                                   const xcsv_columns& columns,
+                                                   const char delimiter,
+                                                   const std::size_t skip_rows,
+                                                   const std::ptrdiff_t max_rows,
+                                                   const std::string comments)
+    {
+        if (columns.size() != sizeof...(T))
         {
-            XTENSOR_THROW(std::runtime_error, "Inconsistent row lengths in CSV");
+            XTENSOR_THROW(std::runtime_error, "load_csv_columns: one type is required per selected column");
         }
-        return tensor_type(std::move(data), std::move(shape), std::move(strides));
+        std::tuple<std::vector<T>...> data;
+        detail::csv_columns_sink<T...> sink(data);
+        detail::csv_line_parser parser(delimiter);
+        detail::csv_load(stream, &columns, sink, parser, delimiter, skip_rows, max_rows, comments);
+        return detail::make_csv_columns(data, std::index_sequence_for<T...>());
     }
 
     /**
      * @brief Dump tensor to CSV.
-     * 
+     *
+     * Rows are formatted by large blocks, in parallel when TBB or OpenMP
+     * is enabled, and each block is written with a single call.
      * @param stream the output stream to write the CSV encoded values
      * @param e the tensor expression to serialize
+     * @param delimiter the character used to separate values. [default: ',']
+     * @param format the notation of floating point values. [default: csv_float_format::stream]
+     * @param precision the precision of floating point values; unused by the stream and shortest notations. [default: 6]
      */
     template <class E>
-    void dump_csv(std::ostream& stream, const xexpression<E>& e)
+    void dump_csv(std::ostream& stream, const xexpression<E>& e, const char delimiter,
+                  csv_float_format format, int precision)
     {
-        using size_type = typename E::size_type;
         const E& ex = e.derived_cast();
         if (ex.dimension() != 2)
         {
             XTENSOR_THROW(std::runtime_error, "Only 2-D expressions can be serialized to CSV");
         }
-        size_type nbrows = ex.shape()[0], nbcols = ex.shape()[1];
-        auto st = ex.stepper_begin(ex.shape());
-        for (size_type r = 0; r != nbrows; ++r)
+        std::size_t nbrows = static_cast<std::size_t>(ex.shape()[0]);
+        std::size_t nbcols = static_cast<std::size_t>(ex.shape()[1]);
+        if (nbrows == 0 || nbcols == 0)
         {
-            for (size_type c = 0; c != nbcols; ++c)
-            {
-                stream << *st;
-                if (c != nbcols - 1)
+            return;
+        }
+        detail::csv_stream_format(stream, format, precision);
+
+        // each block formats about csv_dump_buffer_size bytes (assuming 16 bytes
+        // per cell) into its own buffer, then the buffers are written in order
+        std::size_t block_rows = (std::max)(std::size_t(1), detail::csv_dump_buffer_size / (16 * nbcols));
+        std::size_t n_blocks = detail::parallel_block_count(nbrows * nbcols, detail::csv_dump_grain_size);
+        std::vector<std::string> buffers(n_blocks);
+        std::vector<std::exception_ptr> errors(n_blocks);
+        for (std::size_t first = 0; first < nbrows; first += n_blocks * block_rows)
+        {
+            std::size_t last = (std::min)(nbrows, first + n_blocks * block_rows);
+            detail::parallel_for_blocks(n_blocks, last - first, [&](std::size_t b, std::size_t begin, std::size_t end) {
+                try
                 {
-                    st.step(1);
-                    stream << ',';
+                    buffers[b].clear();
+                    detail::csv_format_rows(buffers[b], ex, first + begin, first + end, delimiter, format, precision, stream);
                 }
-                else
+                catch (...)
+                {
+                    errors[b] = std::current_exception();
+                }
+            });
+            for (std::size_t b = 0; b < n_blocks; ++b)
+            {
+                if (errors[b])
                 {
-                    st.reset(1);
-                    st.step(0);
-                    stream << std::endl;
+                    std::rethrow_exception(errors[b]);
                 }
+                stream.write(buffers[b].data(), static_cast<std::streamsize>(buffers[b].size()));
             }
         }
     }
@@ -205,12 +1356,16 @@ namespace xt
         std::size_t skip_rows;
         std::ptrdiff_t max_rows;
         std::string comments;
+        csv_float_format format;
+        int precision;
 
         xcsv_config()
             : delimiter(',')
             , skip_rows(0)
             , max_rows(-1)
             , comments("#")
+            , format(csv_float_format::stream)
+            , precision(6)
         {
         }
     };
@@ -222,9 +1377,9 @@ namespace xt
     }
 
     template <class E>
-    void dump_file(std::ostream& stream, const xexpression<E> &e, const xcsv_config&)
+    void dump_file(std::ostream& stream, const xexpression<E> &e, const xcsv_config& config)
     {
-        dump_csv(stream, e);
+        dump_csv(stream, e, config.delimiter, config.format, config.precision);
     }
 }
 
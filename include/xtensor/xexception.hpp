@@ -11,6 +11,7 @@
 #define XTENSOR_EXCEPTION_HPP
 
 #include <iterator>
+#include <new>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -54,6 +55,34 @@ namespace xt
     template <class S1, class S2>
     [[noreturn]] void throw_concatenate_error(const S1& lhs, const S2& rhs);
 
+    /********************
+     * allocation_error *
+     ********************/
+
+    /**
+     * Exception thrown by the allocators of xtensor when an allocation
+     * fails. It can be caught as std::bad_alloc. The message must have
+     * static storage duration.
+     */
+    class allocation_error : public std::bad_alloc
+    {
+    public:
+
+        explicit allocation_error(const char* msg) noexcept
+            : p_msg(msg)
+        {
+        }
+
+        const char* what() const noexcept override
+        {
+            return p_msg;
+        }
+
+    private:
+
+        const char* p_msg;
+    };
+
     /**********************************
      * broadcast_error implementation *
      **********************************/
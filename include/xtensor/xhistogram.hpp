@@ -14,6 +14,9 @@
 #ifndef XTENSOR_HISTOGRAM_HPP
 #define XTENSOR_HISTOGRAM_HPP
 
+#include <cmath>
+#include <limits>
+
 #include "xtensor.hpp"
 #include "xsort.hpp"
 #include "xset_operation.hpp"
@@ -46,11 +49,161 @@ namespace xt
 
     namespace detail
     {
+        // Minimal number of elements handled by a parallel block
+        constexpr std::size_t histogram_grain_size = 65536;
+        // Histograms with at most histogram_lane_max_bins bins are accumulated into
+        // histogram_lanes interleaved sub-histograms per block: consecutive elements
+        // increment different copies, which breaks the store-to-load dependency
+        // between increments of the same bin.
+        constexpr std::size_t histogram_lane_max_bins = 1024;
+        constexpr std::size_t histogram_lanes = 4;
+
+        /**
+         * Computes ``count[bin(i)] += weight(i)`` for ``i`` in ``[0, size)``, where ``bin``
+         * returns ``count.size()`` for the elements to ignore. Each parallel block (and,
+         * for small histograms, each lane of a block) accumulates into private bins
+         * that are summed at the end, so that no atomic operation is needed. A single
+         * block with a single lane accumulates directly into ``count``.
+         */
+        template <class C, class B, class W>
+        inline void accumulate_bins(C& count, std::size_t size, B&& bin, W&& weight)
+        {
+            using value_type = typename C::value_type;
+
+            std::size_t n_bins = count.size();
+            // the extra slot absorbs the ignored elements, keeping the loop branch-free
+            std::size_t stride = n_bins + 1;
+            std::size_t lanes = n_bins <= histogram_lane_max_bins ? histogram_lanes : std::size_t(1);
+            // privatizing more bins than elements per block does not pay off
+            std::size_t n_blocks = (std::min)(parallel_block_count(size, histogram_grain_size),
+                                              (std::max)(std::size_t(1), size / (lanes * stride)));
+
+            if (n_blocks == 1 && lanes == 1)
+            {
+                // nothing to privatize: the result is accumulated directly
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    std::size_t b = bin(i);
+                    if (b < n_bins)
+                    {
+                        count(b) += weight(i);
+                    }
+                }
+                return;
+            }
+
+            std::vector<value_type> bins(n_blocks * lanes * stride, value_type(0));
+            parallel_for_blocks(n_blocks, size, [&](std::size_t block, std::size_t begin, std::size_t end) {
+                value_type* local = bins.data() + block * lanes * stride;
+                std::size_t i = begin;
+                for (; i + lanes <= end; i += lanes)
+                {
+                    for (std::size_t l = 0; l < lanes; ++l)
+                    {
+                        local[l * stride + bin(i + l)] += weight(i + l);
+                    }
+                }
+                for (; i < end; ++i)
+                {
+                    local[bin(i)] += weight(i);
+                }
+            });
+
+            for (std::size_t k = 0; k < n_blocks * lanes; ++k)
+            {
+                const value_type* local = bins.data() + k * stride;
+                for (std::size_t b = 0; b < n_bins; ++b)
+                {
+                    count(b) += local[b];
+                }
+            }
+        }
+
+        /**
+         * Binning along one axis. ``bin(v)`` returns the index of the bin containing ``v``,
+         * or ``size()`` when ``v`` is outside of the edges (or NaN). Bins are half-open,
+         * except for the last one which is closed. Equal bins are computed arithmetically,
+         * unequal ones by a binary search over the edges, which is O(log(n_bins)) and
+         * does not allocate.
+         */
+        template <class T>
+        class histogram_axis
+        {
+        public:
+
+            using edge_type = T;
+
+            template <class E>
+            histogram_axis(const E& bin_edges, bool equal_bins)
+                : m_edges(bin_edges.cbegin(), bin_edges.cend()),
+                  m_n_bins(m_edges.size() - 1),
+                  m_left(static_cast<double>(m_edges.front())),
+                  m_right(static_cast<double>(m_edges.back())),
+                  m_norm(1. / (m_right - m_left)),
+                  m_equal_bins(equal_bins)
+            {
+            }
+
+            std::size_t size() const noexcept
+            {
+                return m_n_bins;
+            }
+
+            const std::vector<edge_type>& edges() const noexcept
+            {
+                return m_edges;
+            }
+
+            template <class V>
+            std::size_t bin(const V& value) const
+            {
+                return m_equal_bins ? uniform_bin(value) : search_bin(value);
+            }
+
+        private:
+
+            template <class V>
+            std::size_t uniform_bin(const V& value) const
+            {
+                auto v = static_cast<double>(value);
+                // left and right are not bounds of data
+                if (v >= m_left && v < m_right)
+                {
+                    auto i_bin = static_cast<std::size_t>(static_cast<double>(m_n_bins) * (v - m_left) * m_norm);
+                    // guards against rounding up for values just below right
+                    return (std::min)(i_bin, m_n_bins - 1);
+                }
+                return v == m_right ? m_n_bins - 1 : m_n_bins;
+            }
+
+            template <class V>
+            std::size_t search_bin(const V& value) const
+            {
+                // also rejects NaN
+                if (!(value >= m_edges.front() && value <= m_edges.back()))
+                {
+                    return m_n_bins;
+                }
+                // index of the last edge lower than or equal to value among the
+                // n_bins left edges, so that the last bin is closed
+                auto not_greater = [](const auto& edge, const auto& x) { return !(x < edge); };
+                return branchless_bound(m_edges.data(), m_n_bins, value, not_greater) - 1;
+            }
+
+            std::vector<edge_type> m_edges;
+            std::size_t m_n_bins;
+            double m_left;
+            double m_right;
+            double m_norm;
+            bool m_equal_bins;
+        };
+
         template <class R = double, class E1, class E2, class E3>
         inline auto histogram_imp(E1&& data, E2&& bin_edges, E3&& weights, bool density, bool equal_bins)
         {
             using size_type = common_size_type_t<std::decay_t<E1>, std::decay_t<E2>, std::decay_t<E3>>;
             using value_type = typename std::decay_t<E3>::value_type;
+            using edge_type = typename std::decay_t<E2>::value_type;
 
             XTENSOR_ASSERT(data.dimension() == 1);
             XTENSOR_ASSERT(weights.dimension() == 1);
@@ -62,68 +215,139 @@ namespace xt
             size_t n_bins = bin_edges.size() - 1;
             xt::xtensor<value_type, 1> count = xt::zeros<value_type>({ n_bins });
 
-            if (equal_bins)
+            histogram_axis<edge_type> axis(bin_edges, equal_bins);
+            accumulate_bins(count, data.size(),
+                            [&data, &axis](std::size_t i) { return axis.bin(data(i)); },
+                            [&weights](std::size_t i) { return weights(i); });
+
+            xt::xtensor<R, 1> prob = xt::cast<R>(count);
+
+            if (density)
             {
-                std::array<typename std::decay_t<E2>::value_type, 2> bounds = xt::minmax(bin_edges)();
-                auto left = static_cast<double>(bounds[0]);
-                auto right = static_cast<double>(bounds[1]);
-                double norm = 1. / (right - left);
-                for (size_t i = 0; i < data.size(); ++i)
+                R n = static_cast<R>(data.size());
+                for (size_type i = 0; i < bin_edges.size() - 1; ++i)
                 {
-                    auto v = static_cast<double>(data(i));
-                    // left and right are not bounds of data
-                    if (v >= left && v < right)
-                    {
-                        auto i_bin = static_cast<size_t>(static_cast<double>(n_bins) * (v - left) * norm);
-                        count(i_bin) += weights(i);
-                    }
-                    else if (v == right)
-                    {
-                        count(n_bins - 1) += weights(i);
-                    }
+                    prob[i] /= (static_cast<R>(bin_edges[i + 1] - bin_edges[i]) * n);
                 }
             }
-            else
-            {
-                auto sorter = xt::argsort(data);
 
-                size_type ibin = 0;
+            return prob;
+        }
 
-                for (auto& idx : sorter)
-                {
-                    auto item = data[idx];
+        /**
+         * Multi-dimensional histogram of n samples, where ``value(i, d)`` is the
+         * coordinate of the i-th sample along the d-th axis. The flat index of the
+         * bin of each sample is accumulated with accumulate_bins, so that the
+         * parallel privatized accumulation of the 1-D case is used as is.
+         */
+        template <class R, class V, class T, class W>
+        inline xarray<R> histogramdd_imp(std::size_t n, V&& value, const std::vector<histogram_axis<T>>& axes,
+                                         W&& weight, bool density)
+        {
+            using count_type = std::decay_t<decltype(weight(std::size_t(0)))>;
 
-                    if (item < bin_edges[0])
-                    {
-                        continue;
-                    }
+            std::size_t n_dims = axes.size();
+            dynamic_shape<std::size_t> shape(n_dims);
+            std::vector<std::size_t> strides(n_dims);
+            std::size_t n_total = 1;
+            for (std::size_t d = n_dims; d != 0; --d)
+            {
+                shape[d - 1] = axes[d - 1].size();
+                strides[d - 1] = n_total;
+                n_total *= shape[d - 1];
+            }
 
-                    if (item > bin_edges[n_bins])
+            xt::xtensor<count_type, 1> count = xt::zeros<count_type>({ n_total });
+            auto bin = [&value, &axes, &strides, n_dims, n_total](std::size_t i) {
+                std::size_t flat = 0;
+                for (std::size_t d = 0; d < n_dims; ++d)
+                {
+                    std::size_t b = axes[d].bin(value(i, d));
+                    if (b == axes[d].size())
                     {
-                        break;
+                        return n_total;
                     }
-
-                    while (item >= bin_edges[ibin + 1] && ibin < n_bins - 1)
+                    flat += b * strides[d];
+                }
+                return flat;
+            };
+            accumulate_bins(count, n, bin, std::forward<W>(weight));
+
+            xarray<R> prob = xarray<R>::from_shape(shape);
+            R norm = static_cast<R>(n);
+            // count is flattened in row-major order
+            auto it = prob.template begin<layout_type::row_major>();
+            for (std::size_t k = 0; k < n_total; ++k, ++it)
+            {
+                *it = static_cast<R>(count(k));
+                if (density)
+                {
+                    R volume = R(1);
+                    for (std::size_t d = 0; d < n_dims; ++d)
                     {
-                        ++ibin;
+                        std::size_t b = (k / strides[d]) % shape[d];
+                        const auto& edges = axes[d].edges();
+                        volume *= static_cast<R>(edges[b + 1] - edges[b]);
                     }
-
-                    count[ibin] += weights[idx];
+                    *it /= (volume * norm);
                 }
             }
 
-            xt::xtensor<R, 1> prob = xt::cast<R>(count);
+            return prob;
+        }
 
-            if (density)
+        template <class T, class C>
+        inline auto make_histogram_axes(const C& bin_edges, bool equal_bins)
+        {
+            std::vector<histogram_axis<T>> axes;
+            axes.reserve(bin_edges.size());
+            for (const auto& edges : bin_edges)
             {
-                R n = static_cast<R>(data.size());
-                for (size_type i = 0; i < bin_edges.size() - 1; ++i)
-                {
-                    prob[i] /= (static_cast<R>(bin_edges[i + 1] - bin_edges[i]) * n);
-                }
+                XTENSOR_ASSERT(edges.dimension() == 1);
+                XTENSOR_ASSERT(edges.size() >= 2);
+                XTENSOR_ASSERT(std::is_sorted(edges.cbegin(), edges.cend()));
+                axes.emplace_back(edges, equal_bins);
             }
+            return axes;
+        }
 
-            return prob;
+        // Edges of bins of equal width spanning the n samples; as in numpy, the
+        // range is [0, 1] without samples and is widened by 0.5 on each side
+        // when all the samples are equal
+        template <class F>
+        inline xt::xtensor<double, 1> histogram_equal_edges(std::size_t n, F&& sample, std::size_t bins)
+        {
+            double left = 0., right = 1.;
+            if (n != 0)
+            {
+                left = right = static_cast<double>(sample(0));
+            }
+            for (std::size_t i = 1; i < n; ++i)
+            {
+                auto v = static_cast<double>(sample(i));
+                left = (std::min)(left, v);
+                right = (std::max)(right, v);
+            }
+            if (left == right)
+            {
+                left -= 0.5;
+                right += 0.5;
+            }
+            return xt::linspace<double>(left, right, bins + 1);
+        }
+
+        template <class E>
+        inline auto histogramdd_equal_edges(const E& data, std::size_t bins)
+        {
+            std::size_t n = data.shape()[0];
+            std::size_t n_dims = data.shape()[1];
+            std::vector<xt::xtensor<double, 1>> bin_edges;
+            bin_edges.reserve(n_dims);
+            for (std::size_t d = 0; d < n_dims; ++d)
+            {
+                bin_edges.push_back(histogram_equal_edges(n, [&data, d](std::size_t i) { return data(i, d); }, bins));
+            }
+            return bin_edges;
         }
 
     } //detail
@@ -261,6 +485,574 @@ namespace xt
                                         true);
     }
 
+    /**
+     * @ingroup histogram
+     * @brief Compute the multi-dimensional histogram of a set of samples.
+     *
+     * @param data The samples: a two-dimensional array of shape [N, D].
+     * @param bin_edges A sequence of D one-dimensional, monotonic arrays with the bin-edges along each axis.
+     * @param weights Weight factors corresponding to each sample.
+     * @param density If true the resulting integral is normalized to 1. [default: false]
+     * @return A D-dimensional xarray<R>, of shape (bin_edges[d].size()-1, ...).
+     */
+    template <class R = double, class E1, class C, class E3, XTL_REQUIRES(is_xexpression<std::decay_t<E3>>)>
+    inline auto histogramdd(E1&& data, const C& bin_edges, E3&& weights, bool density = false)
+    {
+        using edge_type = typename std::decay_t<typename C::value_type>::value_type;
+
+        XTENSOR_ASSERT(data.dimension() == 2);
+        XTENSOR_ASSERT(data.shape()[1] == bin_edges.size());
+        XTENSOR_ASSERT(weights.dimension() == 1);
+        XTENSOR_ASSERT(weights.size() == data.shape()[0]);
+
+        auto axes = detail::make_histogram_axes<edge_type>(bin_edges, false);
+        return detail::histogramdd_imp<R>(data.shape()[0],
+                                          [&data](std::size_t i, std::size_t d) { return data(i, d); },
+                                          axes,
+                                          [&weights](std::size_t i) { return weights(i); },
+                                          density);
+    }
+
+    /**
+     * @ingroup histogram
+     * @brief Compute the multi-dimensional histogram of a set of samples.
+     *
+     * @param data The samples: a two-dimensional array of shape [N, D].
+     * @param bin_edges A sequence of D one-dimensional, monotonic arrays with the bin-edges along each axis.
+     * @param density If true the resulting integral is normalized to 1. [default: false]
+     * @return A D-dimensional xarray<R>, of shape (bin_edges[d].size()-1, ...).
+     */
+    template <class R = double, class E1, class C, XTL_REQUIRES(xtl::negation<xtl::is_integral<C>>)>
+    inline auto histogramdd(E1&& data, const C& bin_edges, bool density = false)
+    {
+        using edge_type = typename std::decay_t<typename C::value_type>::value_type;
+
+        XTENSOR_ASSERT(data.dimension() == 2);
+        XTENSOR_ASSERT(data.shape()[1] == bin_edges.size());
+
+        auto axes = detail::make_histogram_axes<edge_type>(bin_edges, false);
+        return detail::histogramdd_imp<R>(data.shape()[0],
+                                          [&data](std::size_t i, std::size_t d) { return data(i, d); },
+                                          axes,
+                                          [](std::size_t) { return 1.; },
+                                          density);
+    }
+
+    /**
+     * @ingroup histogram
+     * @brief Compute the multi-dimensional histogram of a set of samples,
+     * using bins of equal width spanning the range of the data along each axis.
+     *
+     * @param data The samples: a two-dimensional array of shape [N, D].
+     * @param bins The number of bins along each axis. [default: 10]
+     * @param density If true the resulting integral is normalized to 1. [default: false]
+     * @return A D-dimensional xarray<R>, of shape (bins, ..., bins).
+     */
+    template <class R = double, class E1>
+    inline auto histogramdd(E1&& data, std::size_t bins = 10, bool density = false)
+    {
+        XTENSOR_ASSERT(data.dimension() == 2);
+
+        auto axes = detail::make_histogram_axes<double>(detail::histogramdd_equal_edges(data, bins), true);
+        return detail::histogramdd_imp<R>(data.shape()[0],
+                                          [&data](std::size_t i, std::size_t d) { return data(i, d); },
+                                          axes,
+                                          [](std::size_t) { return 1.; },
+                                          density);
+    }
+
+    /**
+     * @ingroup histogram
+     * @brief Compute the two-dimensional histogram of a set of samples.
+     *
+     * @param x The coordinates of the samples along the first axis.
+     * @param y The coordinates of the samples along the second axis.
+     * @param bin_edges_x The bin-edges along the first axis. It has to be 1-dimensional and monotonic.
+     * @param bin_edges_y The bin-edges along the second axis. It has to be 1-dimensional and monotonic.
+     * @param weights Weight factors corresponding to each sample.
+     * @param density If true the resulting integral is normalized to 1. [default: false]
+     * @return A two-dimensional xtensor<R, 2>, of shape (bin_edges_x.size()-1, bin_edges_y.size()-1).
+     */
+    template <class R = double, class E1, class E2, class E3, class E4, class E5,
+              XTL_REQUIRES(is_xexpression<std::decay_t<E5>>)>
+    inline auto histogram2d(E1&& x, E2&& y, E3&& bin_edges_x, E4&& bin_edges_y, E5&& weights, bool density = false)
+    {
+        using edge_type = std::common_type_t<typename std::decay_t<E3>::value_type,
+                                             typename std::decay_t<E4>::value_type>;
+
+        XTENSOR_ASSERT(x.dimension() == 1);
+        XTENSOR_ASSERT(y.dimension() == 1);
+        XTENSOR_ASSERT(x.size() == y.size());
+        XTENSOR_ASSERT(weights.size() == x.size());
+
+        std::vector<detail::histogram_axis<edge_type>> axes;
+        axes.emplace_back(bin_edges_x, false);
+        axes.emplace_back(bin_edges_y, false);
+        xt::xtensor<R, 2> res = detail::histogramdd_imp<R>(x.size(),
+                                                           [&x, &y](std::size_t i, std::size_t d) { return d == 0 ? x(i) : y(i); },
+                                                           axes,
+                                                           [&weights](std::size_t i) { return weights(i); },
+                                                           density);
+        return res;
+    }
+
+    /**
+     * @ingroup histogram
+     * @brief Compute the two-dimensional histogram of a set of samples.
+     *
+     * @param x The coordinates of the samples along the first axis.
+     * @param y The coordinates of the samples along the second axis.
+     * @param bin_edges_x The bin-edges along the first axis. It has to be 1-dimensional and monotonic.
+     * @param bin_edges_y The bin-edges along the second axis. It has to be 1-dimensional and monotonic.
+     * @param density If true the resulting integral is normalized to 1. [default: false]
+     * @return A two-dimensional xtensor<R, 2>, of shape (bin_edges_x.size()-1, bin_edges_y.size()-1).
+     */
+    template <class R = double, class E1, class E2, class E3, class E4,
+              XTL_REQUIRES(is_xexpression<std::decay_t<E3>>, is_xexpression<std::decay_t<E4>>)>
+    inline auto histogram2d(E1&& x, E2&& y, E3&& bin_edges_x, E4&& bin_edges_y, bool density = false)
+    {
+        using value_type = typename std::decay_t<E1>::value_type;
+
+        auto n = x.size();
+
+        return histogram2d<R>(std::forward<E1>(x),
+                              std::forward<E2>(y),
+                              std::forward<E3>(bin_edges_x),
+                              std::forward<E4>(bin_edges_y),
+                              xt::ones<value_type>({ n }),
+                              density);
+    }
+
+    /**
+     * @ingroup histogram
+     * @brief Compute the two-dimensional histogram of a set of samples,
+     * using bins of equal width spanning the range of the data along each axis.
+     *
+     * @param x The coordinates of the samples along the first axis.
+     * @param y The coordinates of the samples along the second axis.
+     * @param bins The number of bins along each axis. [default: 10]
+     * @param density If true the resulting integral is normalized to 1. [default: false]
+     * @return A two-dimensional xtensor<R, 2>, of shape (bins, bins).
+     */
+    template <class R = double, class E1, class E2>
+    inline auto histogram2d(E1&& x, E2&& y, std::size_t bins = 10, bool density = false)
+    {
+        XTENSOR_ASSERT(x.dimension() == 1);
+        XTENSOR_ASSERT(y.dimension() == 1);
+        XTENSOR_ASSERT(x.size() == y.size());
+
+        std::vector<detail::histogram_axis<double>> axes;
+        axes.emplace_back(detail::histogram_equal_edges(x.size(), [&x](std::size_t i) { return x(i); }, bins), true);
+        axes.emplace_back(detail::histogram_equal_edges(y.size(), [&y](std::size_t i) { return y(i); }, bins), true);
+        xt::xtensor<R, 2> res = detail::histogramdd_imp<R>(x.size(),
+                                                           [&x, &y](std::size_t i, std::size_t d) { return d == 0 ? x(i) : y(i); },
+                                                           axes,
+                                                           [](std::size_t) { return 1.; },
+                                                           density);
+        return res;
+    }
+
+    /*************************************
+     * histogram_accumulator declaration *
+     *************************************/
+
+    /**
+     * @class histogram_accumulator
+     * @brief Stateful one-dimensional histogram.
+     *
+     * The histogram_accumulator class accumulates the histogram of data that
+     * arrives in batches. Its memory footprint only depends on the number of bins,
+     * which is bounded. Each batch is binned as in histogram, in parallel when xtensor is built
+     * with TBB or OpenMP support. Accumulators with compatible bins, for instance
+     * filled by different threads, can be merged.
+     *
+     * An accumulator built from a number of bins and a range can be made growing:
+     * bins of the same width are then added on either side so that every finite
+     * sample is counted. When the bins covering the samples would exceed the
+     * maximal number of bins, adjacent pairs of bins are merged, doubling the bin
+     * width, until they fit. All the bins of a growing accumulator are half-open,
+     * while the last bin of a fixed one is closed as in histogram.
+     *
+     * @tparam T The type of the bin edges.
+     * @tparam C The type of the counts.
+     */
+    template <class T = double, class C = double>
+    class histogram_accumulator
+    {
+    public:
+
+        using self_type = histogram_accumulator<T, C>;
+        using edge_type = T;
+        using count_type = C;
+        using edges_type = xtensor<T, 1>;
+        using counts_type = xtensor<C, 1>;
+        using size_type = std::size_t;
+
+        template <class E>
+        explicit histogram_accumulator(const E& bin_edges);
+        histogram_accumulator(size_type bins, edge_type left, edge_type right, bool grow = false,
+                              size_type max_bins = size_type(1) << 20);
+
+        template <class E>
+        void update(const E& data);
+
+        template <class E1, class E2>
+        void update(const E1& data, const E2& weights);
+
+        void merge(const self_type& other);
+        void reset();
+
+        size_type size() const noexcept;
+        size_type samples() const noexcept;
+        bool growing() const noexcept;
+        size_type max_bins() const noexcept;
+
+        const edges_type& edges() const noexcept;
+        const counts_type& counts() const noexcept;
+
+        template <class R = double>
+        xtensor<R, 1> density() const;
+
+    private:
+
+        template <class E, class W>
+        void update_impl(const E& data, W&& weight);
+
+        double grow_index(double value) const;
+        void grow(double first, double last);
+        void rebin(double first, double last, std::size_t levels);
+        void reset_growing_edges();
+
+        edges_type m_edges;
+        counts_type m_counts;
+        detail::histogram_axis<T> m_axis;
+        size_type m_samples;
+        size_type m_max_bins;
+        double m_origin;
+        double m_width;
+        std::ptrdiff_t m_first;
+        bool m_grow;
+    };
+
+    /****************************************
+     * histogram_accumulator implementation *
+     ****************************************/
+
+    /**
+     * Builds an accumulator with the given bin edges, which cannot grow.
+     * @param bin_edges The bin-edges. It has to be 1-dimensional and monotonic.
+     */
+    template <class T, class C>
+    template <class E>
+    inline histogram_accumulator<T, C>::histogram_accumulator(const E& bin_edges)
+        : m_edges(bin_edges),
+          m_counts(xt::zeros<C>({ m_edges.size() - 1 })),
+          m_axis(m_edges, false),
+          m_samples(0),
+          m_max_bins(m_counts.size()),
+          m_origin(0.),
+          m_width(0.),
+          m_first(0),
+          m_grow(false)
+    {
+        XTENSOR_ASSERT(m_edges.size() >= 2);
+        XTENSOR_ASSERT(std::is_sorted(m_edges.cbegin(), m_edges.cend()));
+    }
+
+    /**
+     * Builds an accumulator with bins of equal width.
+     * @param bins The number of bins.
+     * @param left The lower-most edge.
+     * @param right The upper-most edge.
+     * @param grow If true, bins are added when samples fall outside of the edges. [default: false]
+     * @param max_bins The maximal number of bins of a growing accumulator, at least bins and 2. [default: 2^20]
+     */
+    template <class T, class C>
+    inline histogram_accumulator<T, C>::histogram_accumulator(size_type bins, edge_type left, edge_type right, bool grow,
+                                                              size_type max_bins)
+        : m_edges(xt::linspace<T>(left, right, bins + 1)),
+          m_counts(xt::zeros<C>({ bins })),
+          m_axis(m_edges, true),
+          m_samples(0),
+          m_max_bins((std::max)({ max_bins, bins, size_type(2) })),
+          m_origin(static_cast<double>(left)),
+          m_width((static_cast<double>(right) - static_cast<double>(left)) / static_cast<double>(bins)),
+          m_first(0),
+          m_grow(grow)
+    {
+        XTENSOR_ASSERT(bins > std::size_t(0));
+        XTENSOR_ASSERT(left < right);
+        if (m_grow)
+        {
+            reset_growing_edges();
+        }
+    }
+
+    /**
+     * Adds the samples of a one-dimensional batch to the histogram.
+     * @param data The batch of samples.
+     */
+    template <class T, class C>
+    template <class E>
+    inline void histogram_accumulator<T, C>::update(const E& data)
+    {
+        auto&& d = xt::eval(data);
+        update_impl(d, [](std::size_t) { return C(1); });
+    }
+
+    /**
+     * Adds the weighted samples of a one-dimensional batch to the histogram.
+     * @param data The batch of samples.
+     * @param weights Weight factors corresponding to each sample.
+     */
+    template <class T, class C>
+    template <class E1, class E2>
+    inline void histogram_accumulator<T, C>::update(const E1& data, const E2& weights)
+    {
+        auto&& d = xt::eval(data);
+        auto&& w = xt::eval(weights);
+        XTENSOR_ASSERT(w.dimension() == 1);
+        XTENSOR_ASSERT(w.size() == d.size());
+        update_impl(d, [&w](std::size_t i) { return static_cast<C>(w(i)); });
+    }
+
+    /**
+     * Adds the counts of another accumulator. Both accumulators must have the same
+     * edges, or both be growing accumulators built with the same origin and bin
+     * widths that only differ by the merging of bins.
+     * @param other The accumulator to merge.
+     */
+    template <class T, class C>
+    inline void histogram_accumulator<T, C>::merge(const self_type& other)
+    {
+        int exponent = 0;
+        bool same_grid = m_grow && other.m_grow && m_origin == other.m_origin
+                      && std::frexp(m_width / other.m_width, &exponent) == 0.5;
+        if (same_grid)
+        {
+            if (other.m_width > m_width)
+            {
+                // the bins of other are wider, merge ours to match them
+                auto levels = static_cast<std::size_t>(1 - exponent);
+                double scale = std::ldexp(1., static_cast<int>(levels));
+                auto first = static_cast<double>(m_first);
+                rebin(std::floor(first / scale), std::floor((first + static_cast<double>(size()) - 1.) / scale), levels);
+            }
+            double scale = m_width / other.m_width;
+            auto other_first = static_cast<double>(other.m_first);
+            grow(std::floor(other_first / scale),
+                 std::floor((other_first + static_cast<double>(other.size()) - 1.) / scale));
+            scale = m_width / other.m_width;
+            for (std::size_t b = 0; b < other.size(); ++b)
+            {
+                auto k = std::floor((other_first + static_cast<double>(b)) / scale);
+                m_counts(static_cast<std::size_t>(static_cast<std::ptrdiff_t>(k) - m_first)) += other.m_counts(b);
+            }
+        }
+        else if (m_grow == other.m_grow && m_edges == other.m_edges)
+        {
+            m_counts += other.m_counts;
+        }
+        else
+        {
+            XTENSOR_THROW(std::runtime_error, "histogram_accumulator: cannot merge histograms with different bins");
+        }
+        m_samples += other.m_samples;
+    }
+
+    /**
+     * Clears the counts. The edges, including the bins added by growth, are kept.
+     */
+    template <class T, class C>
+    inline void histogram_accumulator<T, C>::reset()
+    {
+        std::fill(m_counts.begin(), m_counts.end(), C(0));
+        m_samples = 0;
+    }
+
+    /**
+     * Returns the number of bins.
+     */
+    template <class T, class C>
+    inline auto histogram_accumulator<T, C>::size() const noexcept -> size_type
+    {
+        return m_counts.size();
+    }
+
+    /**
+     * Returns the number of samples added so far, including those
+     * that fell outside of the edges.
+     */
+    template <class T, class C>
+    inline auto histogram_accumulator<T, C>::samples() const noexcept -> size_type
+    {
+        return m_samples;
+    }
+
+    /**
+     * Returns true if bins are added for samples outside of the edges.
+     */
+    template <class T, class C>
+    inline bool histogram_accumulator<T, C>::growing() const noexcept
+    {
+        return m_grow;
+    }
+
+    /**
+     * Returns the maximal number of bins of a growing accumulator.
+     */
+    template <class T, class C>
+    inline auto histogram_accumulator<T, C>::max_bins() const noexcept -> size_type
+    {
+        return m_max_bins;
+    }
+
+    /**
+     * Returns the bin edges, of length size() + 1.
+     */
+    template <class T, class C>
+    inline auto histogram_accumulator<T, C>::edges() const noexcept -> const edges_type&
+    {
+        return m_edges;
+    }
+
+    /**
+     * Returns the counts accumulated so far, without copying them. The reference
+     * is invalidated when a growing accumulator adds bins.
+     */
+    template <class T, class C>
+    inline auto histogram_accumulator<T, C>::counts() const noexcept -> const counts_type&
+    {
+        return m_counts;
+    }
+
+    /**
+     * Returns the counts normalized such that the integral of the histogram is 1,
+     * as histogram does with density set to true.
+     */
+    template <class T, class C>
+    template <class R>
+    inline xtensor<R, 1> histogram_accumulator<T, C>::density() const
+    {
+        xtensor<R, 1> prob = xt::cast<R>(m_counts);
+        R n = static_cast<R>(m_samples);
+        for (std::size_t i = 0; i < prob.size(); ++i)
+        {
+            prob(i) /= (static_cast<R>(m_edges(i + 1) - m_edges(i)) * n);
+        }
+        return prob;
+    }
+
+    template <class T, class C>
+    template <class E, class W>
+    inline void histogram_accumulator<T, C>::update_impl(const E& data, W&& weight)
+    {
+        XTENSOR_ASSERT(data.dimension() == 1);
+
+        std::size_t n = data.size();
+        if (m_grow)
+        {
+            // bins are added before accumulating, so that the accumulation itself
+            // works on fixed bins and never reallocates
+            double first = static_cast<double>(m_first);
+            double last = first + static_cast<double>(size()) - 1.;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                auto v = static_cast<double>(data(i));
+                if (std::isfinite(v))
+                {
+                    double k = grow_index(v);
+                    first = (std::min)(first, k);
+                    last = (std::max)(last, k);
+                }
+            }
+            grow(first, last);
+
+            std::size_t n_bins = size();
+            double origin = static_cast<double>(m_first);
+            detail::accumulate_bins(m_counts, n,
+                                    [&data, this, n_bins, origin](std::size_t i) {
+                                        auto v = static_cast<double>(data(i));
+                                        return std::isfinite(v) ? static_cast<std::size_t>(grow_index(v) - origin) : n_bins;
+                                    },
+                                    weight);
+        }
+        else
+        {
+            detail::accumulate_bins(m_counts, n,
+                                    [&data, this](std::size_t i) { return m_axis.bin(data(i)); },
+                                    weight);
+        }
+        m_samples += n;
+    }
+
+    template <class T, class C>
+    inline double histogram_accumulator<T, C>::grow_index(double value) const
+    {
+        // the index of a bin relative to the origin does not depend on the bins
+        // added so far, hence samples always fall in the same bin
+        return std::floor((value - m_origin) / m_width);
+    }
+
+    template <class T, class C>
+    inline void histogram_accumulator<T, C>::grow(double first, double last)
+    {
+        auto old_first = static_cast<double>(m_first);
+        auto old_last = old_first + static_cast<double>(size()) - 1.;
+        if (first >= old_first && last <= old_last)
+        {
+            return;
+        }
+
+        first = (std::min)(first, old_first);
+        last = (std::max)(last, old_last);
+        // merges adjacent pairs of bins until the samples are covered by at most
+        // m_max_bins bins
+        std::size_t levels = 0;
+        while (last - first >= static_cast<double>(m_max_bins))
+        {
+            first = std::floor(first / 2.);
+            last = std::floor(last / 2.);
+            ++levels;
+        }
+        if (last - first >= static_cast<double>(std::numeric_limits<std::ptrdiff_t>::max() / std::ptrdiff_t(sizeof(C))))
+        {
+            XTENSOR_THROW(std::runtime_error, "histogram_accumulator: too many bins to cover the samples");
+        }
+        rebin(first, last, levels);
+    }
+
+    // Moves the counts to the bins [first, last] relative to the origin, whose
+    // width is the current one multiplied by 2^levels
+    template <class T, class C>
+    inline void histogram_accumulator<T, C>::rebin(double first, double last, std::size_t levels)
+    {
+        auto new_first = static_cast<std::ptrdiff_t>(first);
+        counts_type counts = xt::zeros<C>({ static_cast<std::size_t>(last - first) + 1 });
+        double scale = std::ldexp(1., static_cast<int>(levels));
+        for (std::size_t b = 0; b < m_counts.size(); ++b)
+        {
+            auto k = std::floor(static_cast<double>(m_first + static_cast<std::ptrdiff_t>(b)) / scale);
+            counts(static_cast<std::size_t>(static_cast<std::ptrdiff_t>(k) - new_first)) += m_counts(b);
+        }
+        m_counts = std::move(counts);
+        m_first = new_first;
+        m_width *= scale;
+        reset_growing_edges();
+    }
+
+    template <class T, class C>
+    inline void histogram_accumulator<T, C>::reset_growing_edges()
+    {
+        std::size_t n_bins = size();
+        m_edges = edges_type::from_shape({ n_bins + 1 });
+        for (std::size_t k = 0; k <= n_bins; ++k)
+        {
+            m_edges(k) = static_cast<T>(m_origin + static_cast<double>(m_first + static_cast<std::ptrdiff_t>(k)) * m_width);
+        }
+        m_axis = detail::histogram_axis<T>(m_edges, true);
+    }
+
     /**
      * @ingroup histogram
      * @brief Defines different algorithms to be used in "histogram_bin_edges"
@@ -498,7 +1290,6 @@ namespace xt
     {
         using result_value_type = typename std::decay_t<E2>::value_type;
         using input_value_type = typename std::decay_t<E1>::value_type;
-        using size_type = typename std::decay_t<E1>::size_type;
 
         static_assert(xtl::is_integral<typename std::decay_t<E1>::value_type>::value,
                       "Bincount data has to be integral type.");
@@ -517,10 +1308,9 @@ namespace xt
         xt::xtensor<result_value_type, 1> res = xt::zeros<result_value_type>(
             { (std::max)(minlength, std::size_t(left_right[1] + 1)) });
 
-        for (size_type i = 0; i < data.size(); ++i)
-        {
-            res(data(i)) += weights(i);
-        }
+        detail::accumulate_bins(res, data.size(),
+                                [&data](std::size_t i) { return static_cast<std::size_t>(data(i)); },
+                                [&weights](std::size_t i) { return weights(i); });
 
         return res;
     }
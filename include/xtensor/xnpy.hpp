@@ -18,22 +18,58 @@
 #include <xtl/xplatform.hpp>
 
 #include <algorithm>
+#include <array>
+#include <cerrno>
 #include <complex>
 #include <cstdint>
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <memory>
+#include <numeric>
 #include <regex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <typeinfo>
 #include <vector>
 
+#if defined(_WIN32)
+// Only the file and memory mapping API is used: the lean include keeps out
+// the rarely used headers, and NOMINMAX the min and max macros. The macros
+// defined here are removed afterwards so that they do not leak to the
+// including code.
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#define XTENSOR_NPY_UNDEF_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#define XTENSOR_NPY_UNDEF_NOMINMAX
+#endif
+#include <windows.h>
+#ifdef XTENSOR_NPY_UNDEF_LEAN_AND_MEAN
+#undef WIN32_LEAN_AND_MEAN
+#undef XTENSOR_NPY_UNDEF_LEAN_AND_MEAN
+#endif
+#ifdef XTENSOR_NPY_UNDEF_NOMINMAX
+#undef NOMINMAX
+#undef XTENSOR_NPY_UNDEF_NOMINMAX
+#endif
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "xtensor/xadapt.hpp"
 #include "xtensor/xarray.hpp"
 #include "xtensor/xeval.hpp"
+#include "xtensor/xslice.hpp"
 #include "xtensor/xstrides.hpp"
 #include "xtensor_config.hpp"
 
@@ -348,9 +384,9 @@ namespace xt
             }
         }
 
-        template <class O, class S>
-        inline void write_header(O& out, const std::string& descr,
-                                 bool fortran_order, const S& shape)
+        template <class S>
+        inline std::string build_header_dict(const std::string& descr,
+                                             bool fortran_order, const S& shape)
         {
             std::ostringstream ss_header;
             std::string s_fortran_order;
@@ -385,28 +421,42 @@ namespace xt
                       << "', 'fortran_order': " << s_fortran_order
                       << ", 'shape': " << s_shape << ", }";
 
-            std::size_t header_len_pre = ss_header.str().length() + 1;
+            return ss_header.str();
+        }
+
+        // Size of the magic string, version, header length and header
+        // for a header dictionary of the given length
+        inline std::size_t header_total_length(std::size_t dict_len, unsigned char& v_major)
+        {
+            std::size_t header_len_pre = dict_len + 1;
             std::size_t metadata_len = magic_string_length + 2 + 2 + header_len_pre;
 
-            unsigned char version[2] = {1, 0};
+            v_major = 1;
             if (metadata_len >= 255 * 255)
             {
                 metadata_len = magic_string_length + 2 + 4 + header_len_pre;
-                version[0] = 2;
-                version[1] = 0;
+                v_major = 2;
             }
             std::size_t padding_len = 64 - (metadata_len % 64);
-            std::string padding(padding_len, ' ');
-            ss_header << padding;
-            ss_header << std::endl;
+            return metadata_len + padding_len;
+        }
 
-            std::string header = ss_header.str();
+        // Writes the magic string and the header dictionary, padded with spaces
+        // so that the data starts at total_len
+        template <class O>
+        inline void write_header_block(O& out, const std::string& dict,
+                                       unsigned char v_major, std::size_t total_len)
+        {
+            std::size_t prefix_len = magic_string_length + 2 + (v_major == 1 ? 2 : 4);
+            std::string header = dict;
+            header.append(total_len - prefix_len - dict.size() - 1, ' ');
+            header += '\n';
 
             // write magic
-            write_magic(out, version[0], version[1]);
+            write_magic(out, v_major, 0);
 
             // write header length
-            if (version[0] == 1 && version[1] == 0)
+            if (v_major == 1)
             {
                 char header_len_le16[2];
                 uint16_t header_len = uint16_t(header.length());
@@ -430,6 +480,16 @@ namespace xt
             out << header;
         }
 
+        template <class O, class S>
+        inline void write_header(O& out, const std::string& descr,
+                                 bool fortran_order, const S& shape)
+        {
+            std::string dict = build_header_dict(descr, fortran_order, shape);
+            unsigned char v_major;
+            std::size_t total_len = header_total_length(dict.size(), v_major);
+            write_header_block(out, dict, v_major, total_len);
+        }
+
         inline std::string read_header_1_0(std::istream& istream)
         {
             // read header length and convert from little endian
@@ -600,21 +660,33 @@ namespace xt
             char* m_buffer;
         };
 
-        inline npy_file load_npy_file(std::istream& stream)
+        struct npy_header
+        {
+            std::vector<std::size_t> shape;
+            bool fortran_order;
+            std::string typestring;
+            // offset of the data from the beginning of the npy content
+            std::size_t offset;
+        };
+
+        inline npy_header read_npy_header(std::istream& stream)
         {
             // check magic bytes an version number
             unsigned char v_major, v_minor;
             detail::read_magic(stream, &v_major, &v_minor);
 
             std::string header;
+            std::size_t header_len_size;
 
             if (v_major == 1 && v_minor == 0)
             {
                 header = detail::read_header_1_0(stream);
+                header_len_size = 2;
             }
             else if (v_major == 2 && v_minor == 0)
             {
                 header = detail::read_header_2_0(stream);
+                header_len_size = 4;
             }
             else
             {
@@ -622,109 +694,1526 @@ namespace xt
             }
 
             // parse header
-            bool fortran_order;
-            std::string typestr;
+            npy_header result;
+            detail::parse_header(header, result.typestring, &result.fortran_order, result.shape);
+            result.offset = magic_string_length + 2 + header_len_size + header.size();
+            return result;
+        }
 
-            std::vector<std::size_t> shape;
-            detail::parse_header(header, typestr, &fortran_order, shape);
+        inline npy_file load_npy_file(std::istream& stream)
+        {
+            npy_header header = read_npy_header(stream);
 
-            npy_file result(shape, fortran_order, typestr);
+            npy_file result(header.shape, header.fortran_order, header.typestring);
             // read the data
             stream.read(result.ptr(), std::streamsize((result.n_bytes())));
             return result;
         }
 
-        template <class O, class E>
-        inline void dump_npy_stream(O& stream, const xexpression<E>& e)
+        /**
+         * Memory mapping of a whole file. The mapping is read-only, or private
+         * when writable: pages are copied on the first write, and modifications
+         * are never written back to the file.
+         */
+        class mapped_file
         {
-            using value_type = typename E::value_type;
-            const E& ex = e.derived_cast();
-            auto&& eval_ex = eval(ex);
-            bool fortran_order = false;
-            if (eval_ex.layout() == layout_type::column_major && eval_ex.dimension() > 1)
+        public:
+
+            mapped_file(const std::string& filename, bool writable);
+            ~mapped_file();
+
+            mapped_file(const mapped_file&) = delete;
+            mapped_file& operator=(const mapped_file&) = delete;
+
+            char* data() const noexcept;
+            std::size_t size() const noexcept;
+
+        private:
+
+            char* m_data;
+            std::size_t m_size;
+        };
+
+#if defined(_WIN32)
+        inline mapped_file::mapped_file(const std::string& filename, bool writable)
+            : m_data(nullptr), m_size(0)
+        {
+            HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
             {
-                fortran_order = true;
+                XTENSOR_THROW(std::runtime_error, "io error: failed to open a file.");
+            }
+            LARGE_INTEGER size;
+            HANDLE mapping = nullptr;
+            if (GetFileSizeEx(file, &size))
+            {
+                mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+            }
+            // the mapping keeps the file open
+            CloseHandle(file);
+            if (mapping == nullptr)
+            {
+                XTENSOR_THROW(std::runtime_error, "io error: failed to map a file.");
+            }
+            void* view = MapViewOfFile(mapping, writable ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            if (view == nullptr)
+            {
+                XTENSOR_THROW(std::runtime_error, "io error: failed to map a file.");
             }
+            m_data = static_cast<char*>(view);
+            m_size = static_cast<std::size_t>(size.QuadPart);
+        }
 
-            std::string typestring = detail::build_typestring<value_type>();
+        inline mapped_file::~mapped_file()
+        {
+            UnmapViewOfFile(m_data);
+        }
+#else
+        inline mapped_file::mapped_file(const std::string& filename, bool writable)
+            : m_data(nullptr), m_size(0)
+        {
+            int fd = ::open(filename.c_str(), O_RDONLY);
+            if (fd == -1)
+            {
+                XTENSOR_THROW(std::runtime_error, "io error: failed to open a file.");
+            }
+            struct stat st;
+            void* view = MAP_FAILED;
+            if (::fstat(fd, &st) == 0 && st.st_size > 0)
+            {
+                m_size = static_cast<std::size_t>(st.st_size);
+                view = ::mmap(nullptr, m_size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+            }
+            // the mapping keeps the file open
+            ::close(fd);
+            if (view == MAP_FAILED)
+            {
+                XTENSOR_THROW(std::runtime_error, "io error: failed to map a file.");
+            }
+            m_data = static_cast<char*>(view);
+        }
 
-            auto shape = eval_ex.shape();
-            detail::write_header(stream, typestring, fortran_order, shape);
+        inline mapped_file::~mapped_file()
+        {
+            ::munmap(m_data, m_size);
+        }
+#endif
 
-            std::size_t size = compute_size(shape);
-            stream.write(reinterpret_cast<const char*>(eval_ex.data()),
-                         std::streamsize((sizeof(value_type) * size)));
+        inline char* mapped_file::data() const noexcept
+        {
+            return m_data;
         }
-    }  // namespace detail
 
+        inline std::size_t mapped_file::size() const noexcept
+        {
+            return m_size;
+        }
 
-    /**
-     * Save xexpression to NumPy npy format
-     *
-     * @param filename The filename or path to dump the data
-     * @param e the xexpression
-     */
-    template <typename E>
-    inline void dump_npy(const std::string& filename, const xexpression<E>& e)
-    {
-        std::ofstream stream(filename, std::ofstream::binary);
-        if (!stream)
+        /**
+         * File read at explicit offsets, without a shared file position.
+         */
+        class positioned_file
         {
-            XTENSOR_THROW(std::runtime_error, "IO Error: failed to open file: "s + filename);
+        public:
+
+            explicit positioned_file(const std::string& filename);
+            ~positioned_file();
+
+            positioned_file(const positioned_file&) = delete;
+            positioned_file& operator=(const positioned_file&) = delete;
+
+            void read(char* dest, std::size_t size, std::size_t offset);
+            std::size_t size() const;
+
+        private:
+
+#if defined(_WIN32)
+            HANDLE m_handle;
+#else
+            int m_fd;
+#endif
+        };
+
+#if defined(_WIN32)
+        inline positioned_file::positioned_file(const std::string& filename)
+            : m_handle(CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                   OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr))
+        {
+            if (m_handle == INVALID_HANDLE_VALUE)
+            {
+                XTENSOR_THROW(std::runtime_error, "io error: failed to open a file.");
+            }
         }
 
-        detail::dump_npy_stream(stream, e);
-    }
+        inline positioned_file::~positioned_file()
+        {
+            CloseHandle(m_handle);
+        }
 
-    /**
-     * Save xexpression to NumPy npy format in a string
-     *
-     * @param e the xexpression
-     */
-    template <typename E>
-    inline std::string dump_npy(const xexpression<E>& e)
-    {
-        std::stringstream stream;
-        detail::dump_npy_stream(stream, e);
-        return stream.str();
-    }
+        inline void positioned_file::read(char* dest, std::size_t size, std::size_t offset)
+        {
+            while (size > 0)
+            {
+                DWORD chunk = static_cast<DWORD>((std::min)(size, std::size_t(1) << 30));
+                OVERLAPPED overlapped = {};
+                overlapped.Offset = static_cast<DWORD>(static_cast<std::uint64_t>(offset) & 0xffffffff);
+                overlapped.OffsetHigh = static_cast<DWORD>(static_cast<std::uint64_t>(offset) >> 32);
+                DWORD n = 0;
+                if (!ReadFile(m_handle, dest, chunk, &n, &overlapped) || n == 0)
+                {
+                    XTENSOR_THROW(std::runtime_error, "io error: failed reading file");
+                }
+                dest += n;
+                size -= n;
+                offset += n;
+            }
+        }
 
-    /**
-     * Loads a npy file (the numpy storage format)
-     *
-     * @param stream An input stream from which to load the file
-     * @tparam T select the type of the npy file (note: currently there is
-     *           no dynamic casting if types do not match)
-     * @tparam L select layout_type::column_major if you stored data in
-     *           Fortran format
-     * @return xarray with contents from npy file
-     */
-    template <typename T, layout_type L = layout_type::dynamic>
-    inline auto load_npy(std::istream& stream)
-    {
-        detail::npy_file file = detail::load_npy_file(stream);
-        return std::move(file).cast<T, L>();
-    }
+        inline std::size_t positioned_file::size() const
+        {
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(m_handle, &size))
+            {
+                XTENSOR_THROW(std::runtime_error, "io error: failed reading file");
+            }
+            return static_cast<std::size_t>(size.QuadPart);
+        }
+#else
+        inline positioned_file::positioned_file(const std::string& filename)
+            : m_fd(::open(filename.c_str(), O_RDONLY))
+        {
+            if (m_fd == -1)
+            {
+                XTENSOR_THROW(std::runtime_error, "io error: failed to open a file.");
+            }
+        }
 
-    /**
-     * Loads a npy file (the numpy storage format)
-     *
-     * @param filename The filename or path to the file
-     * @tparam T select the type of the npy file (note: currently there is
-     *           no dynamic casting if types do not match)
-     * @tparam L select layout_type::column_major if you stored data in
-     *           Fortran format
-     * @return xarray with contents from npy file
-     */
-    template <typename T, layout_type L = layout_type::dynamic>
-    inline auto load_npy(const std::string& filename)
-    {
-        std::ifstream stream(filename, std::ifstream::binary);
-        if (!stream)
+        inline positioned_file::~positioned_file()
         {
-            XTENSOR_THROW(std::runtime_error, "io error: failed to open a file.");
+            ::close(m_fd);
+        }
+
+        inline void positioned_file::read(char* dest, std::size_t size, std::size_t offset)
+        {
+            while (size > 0)
+            {
+                ssize_t n = ::pread(m_fd, dest, size, static_cast<off_t>(offset));
+                if (n < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (n <= 0)
+                {
+                    XTENSOR_THROW(std::runtime_error, "io error: failed reading file");
+                }
+                dest += n;
+                size -= static_cast<std::size_t>(n);
+                offset += static_cast<std::size_t>(n);
+            }
+        }
+
+        inline std::size_t positioned_file::size() const
+        {
+            struct stat st;
+            if (::fstat(m_fd, &st) != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "io error: failed reading file");
+            }
+            return static_cast<std::size_t>(st.st_size);
+        }
+#endif
+
+        // Reads separated by at most npy_slice_gap_size bytes are merged into a
+        // single one, the gap being discarded: reading a few more bytes is cheaper
+        // than an additional system call. npy_slice_buffer_size bounds the size
+        // of the staging buffer used for merged reads.
+        constexpr std::size_t npy_slice_gap_size = 4096;
+        constexpr std::size_t npy_slice_buffer_size = std::size_t(1) << 20;
+
+        /**
+         * Reads byte ranges of a file, in order, into consecutive memory. Contiguous
+         * and nearby ranges are coalesced before being read.
+         */
+        class npy_slice_reader
+        {
+        public:
+
+            npy_slice_reader(positioned_file& file, char* dest);
+
+            void add(std::size_t offset, std::size_t size);
+            void flush();
+
+        private:
+
+            positioned_file& m_file;
+            char* m_dest;
+            std::size_t m_begin;
+            std::size_t m_end;
+            std::vector<std::pair<std::size_t, std::size_t>> m_segments;
+            std::vector<char> m_buffer;
+        };
+
+        inline npy_slice_reader::npy_slice_reader(positioned_file& file, char* dest)
+            : m_file(file), m_dest(dest), m_begin(0), m_end(0)
+        {
+        }
+
+        inline void npy_slice_reader::add(std::size_t offset, std::size_t size)
+        {
+            if (!m_segments.empty())
+            {
+                // a single segment is read directly, without staging buffer
+                if (offset == m_end && (m_segments.size() == 1 || offset + size - m_begin <= npy_slice_buffer_size))
+                {
+                    m_segments.back().second += size;
+                    m_end += size;
+                    return;
+                }
+                if (offset > m_end && offset - m_end <= npy_slice_gap_size
+                    && offset + size - m_begin <= npy_slice_buffer_size)
+                {
+                    m_segments.emplace_back(offset, size);
+                    m_end = offset + size;
+                    return;
+                }
+                flush();
+            }
+            m_segments.emplace_back(offset, size);
+            m_begin = offset;
+            m_end = offset + size;
+        }
+
+        inline void npy_slice_reader::flush()
+        {
+            if (m_segments.size() == 1)
+            {
+                m_file.read(m_dest, m_segments.front().second, m_segments.front().first);
+                m_dest += m_segments.front().second;
+            }
+            else if (m_segments.size() > 1)
+            {
+                m_buffer.resize(m_end - m_begin);
+                m_file.read(m_buffer.data(), m_buffer.size(), m_begin);
+                for (const auto& segment : m_segments)
+                {
+                    std::memcpy(m_dest, m_buffer.data() + (segment.first - m_begin), segment.second);
+                    m_dest += segment.second;
+                }
+            }
+            m_segments.clear();
+        }
+
+        // Minimal expression interface required by get_slice_implementation
+        struct npy_slice_shape
+        {
+            using size_type = std::size_t;
+
+            const std::vector<std::size_t>& shape() const noexcept
+            {
+                return m_shape;
+            }
+
+            std::size_t shape(std::size_t i) const
+            {
+                return m_shape[i];
+            }
+
+            std::vector<std::size_t> m_shape;
+        };
+
+        // Indices selected along a dimension of a npy file, and whether
+        // this dimension is kept in the result
+        struct npy_slice_dim
+        {
+            std::vector<std::size_t> indices;
+            bool keep;
+        };
+
+        template <class I>
+        inline std::enable_if_t<xtl::is_integral<I>::value, npy_slice_dim>
+        npy_slice_indices(I index, std::size_t size)
+        {
+            auto i = static_cast<std::size_t>(index);
+            if (i >= size)
+            {
+                XTENSOR_THROW(std::out_of_range, "npy slice index out of bounds");
+            }
+            return npy_slice_dim{{i}, false};
+        }
+
+        template <class S>
+        inline npy_slice_dim npy_slice_indices(const xslice<S>& slice, std::size_t)
+        {
+            const S& sl = slice.derived_cast();
+            npy_slice_dim res{std::vector<std::size_t>(sl.size()), true};
+            for (std::size_t i = 0; i < res.indices.size(); ++i)
+            {
+                res.indices[i] = static_cast<std::size_t>(sl(i));
+            }
+            return res;
+        }
+
+        // newaxis does not select anything in the file
+        template <class T>
+        npy_slice_dim npy_slice_indices(const xnewaxis<T>&, std::size_t) = delete;
+
+        template <class S>
+        inline npy_slice_dim make_npy_slice_dim(const npy_slice_shape& e, S&& slice, std::size_t dim)
+        {
+            return npy_slice_indices(get_slice_implementation(e, std::forward<S>(slice), dim), e.m_shape[dim]);
+        }
+
+        /**
+         * Reads the elements selected by dims, given in storage order, of a npy
+         * payload starting at offset. Dimensions past the last partially selected
+         * one are contiguous in the file, hence each run of consecutive indices
+         * along that dimension is a single range of bytes.
+         */
+        inline void read_npy_slice(positioned_file& file, std::size_t offset, const std::vector<std::size_t>& shape,
+                                   const std::vector<npy_slice_dim>& dims, std::size_t word_size, char* dest)
+        {
+            std::size_t n_dims = shape.size();
+            for (const auto& dim : dims)
+            {
+                if (dim.indices.empty())
+                {
+                    return;
+                }
+            }
+
+            std::vector<std::size_t> strides(n_dims);
+            std::size_t stride = 1;
+            for (std::size_t d = n_dims; d != 0; --d)
+            {
+                strides[d - 1] = stride;
+                stride *= shape[d - 1];
+            }
+
+            auto is_full = [&dims, &shape](std::size_t d) {
+                const auto& indices = dims[d].indices;
+                if (indices.size() != shape[d])
+                {
+                    return false;
+                }
+                for (std::size_t i = 0; i < indices.size(); ++i)
+                {
+                    if (indices[i] != i)
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            };
+
+            std::size_t inner = n_dims;
+            while (inner != 0 && is_full(inner - 1))
+            {
+                --inner;
+            }
+
+            npy_slice_reader reader(file, dest);
+            if (inner == 0)
+            {
+                reader.add(offset, stride * word_size);
+                reader.flush();
+                return;
+            }
+
+            std::size_t last = inner - 1;
+            std::size_t block = strides[last] * word_size;
+            std::vector<std::pair<std::size_t, std::size_t>> runs;
+            for (std::size_t index : dims[last].indices)
+            {
+                if (!runs.empty() && index == runs.back().first + runs.back().second)
+                {
+                    ++runs.back().second;
+                }
+                else
+                {
+                    runs.emplace_back(index, 1);
+                }
+            }
+
+            // odometer over the selected indices of the outer dimensions
+            std::vector<std::size_t> counter(last, 0);
+            for (;;)
+            {
+                std::size_t base = 0;
+                for (std::size_t d = 0; d < last; ++d)
+                {
+                    base += dims[d].indices[counter[d]] * strides[d];
+                }
+                for (const auto& run : runs)
+                {
+                    reader.add(offset + base * word_size + run.first * block, run.second * block);
+                }
+
+                std::size_t d = last;
+                while (d != 0 && ++counter[d - 1] == dims[d - 1].indices.size())
+                {
+                    counter[d - 1] = 0;
+                    --d;
+                }
+                if (d == 0)
+                {
+                    break;
+                }
+            }
+            reader.flush();
+        }
+
+        // Stored (uncompressed) zip archives, the container of npz files
+
+        constexpr std::uint32_t zip_local_signature = 0x04034b50;
+        constexpr std::uint32_t zip_central_signature = 0x02014b50;
+        constexpr std::uint32_t zip_end_signature = 0x06054b50;
+        constexpr std::uint32_t zip64_end_signature = 0x06064b50;
+        constexpr std::uint32_t zip64_locator_signature = 0x07064b50;
+        constexpr std::uint16_t zip64_extra_id = 0x0001;
+        // extra field used by zipalign to pad local headers
+        constexpr std::uint16_t zip_alignment_extra_id = 0xd935;
+        constexpr std::size_t zip_local_header_size = 30;
+        constexpr std::size_t zip_central_header_size = 46;
+        constexpr std::size_t zip_end_size = 22;
+        constexpr std::size_t zip64_end_size = 56;
+        constexpr std::size_t zip64_locator_size = 20;
+        constexpr std::uint64_t zip_max32 = 0xffffffff;
+        constexpr std::uint32_t zip_max16 = 0xffff;
+        // the npy data of the members written by dump_npz starts on this
+        // boundary in the file, so that it can be mapped for any value type
+        constexpr std::size_t npz_alignment = 64;
+
+        inline std::uint32_t crc32(std::uint32_t crc, const char* data, std::size_t size)
+        {
+            static const auto table = [] {
+                std::array<std::uint32_t, 256> t;
+                for (std::uint32_t i = 0; i < 256; ++i)
+                {
+                    std::uint32_t c = i;
+                    for (int k = 0; k < 8; ++k)
+                    {
+                        c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+                    }
+                    t[i] = c;
+                }
+                return t;
+            }();
+
+            crc = ~crc;
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xff] ^ (crc >> 8);
+            }
+            return ~crc;
+        }
+
+        template <class I>
+        inline void zip_put(std::string& buf, I value)
+        {
+            for (std::size_t i = 0; i < sizeof(I); ++i)
+            {
+                buf += static_cast<char>((static_cast<std::uint64_t>(value) >> (8 * i)) & 0xff);
+            }
+        }
+
+        template <class I>
+        inline I zip_get(const char* p)
+        {
+            std::uint64_t value = 0;
+            for (std::size_t i = 0; i < sizeof(I); ++i)
+            {
+                value |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+            }
+            return static_cast<I>(value);
+        }
+
+        struct zip_member
+        {
+            std::string name;
+            std::uint32_t crc;
+            std::uint64_t compressed_size;
+            std::uint64_t size;
+            std::uint64_t offset;
+            std::uint16_t method;
+        };
+
+        /**
+         * Reads the central directory of a zip file. cd_offset is set to the
+         * offset of the central directory, where new members can be written.
+         */
+        inline std::vector<zip_member> read_zip_directory(positioned_file& file, std::size_t& cd_offset)
+        {
+            std::size_t file_size = file.size();
+            std::size_t tail_size = (std::min)(file_size, zip_end_size + zip_max16);
+            std::vector<char> tail(tail_size);
+            file.read(tail.data(), tail_size, file_size - tail_size);
+
+            // the end of central directory record is followed by a comment of at most 64 KiB
+            std::size_t end_pos = tail_size;
+            for (std::size_t pos = tail_size >= zip_end_size ? tail_size - zip_end_size + 1 : 0; pos-- > 0;)
+            {
+                if (zip_get<std::uint32_t>(tail.data() + pos) == zip_end_signature)
+                {
+                    end_pos = pos;
+                    break;
+                }
+            }
+            if (end_pos == tail_size)
+            {
+                XTENSOR_THROW(std::runtime_error, "this file do not have a valid zip format.");
+            }
+
+            const char* end = tail.data() + end_pos;
+            std::uint64_t n_entries = zip_get<std::uint16_t>(end + 10);
+            std::uint64_t cd_size = zip_get<std::uint32_t>(end + 12);
+            cd_offset = zip_get<std::uint32_t>(end + 16);
+
+            if (n_entries == zip_max16 || cd_size == zip_max32 || cd_offset == zip_max32)
+            {
+                std::size_t end_offset = file_size - tail_size + end_pos;
+                char locator[zip64_locator_size];
+                char end64[zip64_end_size];
+                if (end_offset < zip64_locator_size)
+                {
+                    XTENSOR_THROW(std::runtime_error, "invalid zip64 end of central directory");
+                }
+                file.read(locator, zip64_locator_size, end_offset - zip64_locator_size);
+                if (zip_get<std::uint32_t>(locator) != zip64_locator_signature)
+                {
+                    XTENSOR_THROW(std::runtime_error, "invalid zip64 end of central directory");
+                }
+                file.read(end64, zip64_end_size, zip_get<std::uint64_t>(locator + 8));
+                if (zip_get<std::uint32_t>(end64) != zip64_end_signature)
+                {
+                    XTENSOR_THROW(std::runtime_error, "invalid zip64 end of central directory");
+                }
+                n_entries = zip_get<std::uint64_t>(end64 + 32);
+                cd_size = zip_get<std::uint64_t>(end64 + 40);
+                cd_offset = zip_get<std::uint64_t>(end64 + 48);
+            }
+
+            std::vector<char> cd(cd_size);
+            file.read(cd.data(), cd.size(), cd_offset);
+
+            std::vector<zip_member> members;
+            members.reserve(n_entries);
+            std::size_t pos = 0;
+            for (std::uint64_t k = 0; k < n_entries; ++k)
+            {
+                if (pos + zip_central_header_size > cd.size() || zip_get<std::uint32_t>(cd.data() + pos) != zip_central_signature)
+                {
+                    XTENSOR_THROW(std::runtime_error, "invalid zip central directory");
+                }
+                const char* h = cd.data() + pos;
+                zip_member m;
+                m.method = zip_get<std::uint16_t>(h + 10);
+                m.crc = zip_get<std::uint32_t>(h + 16);
+                m.compressed_size = zip_get<std::uint32_t>(h + 20);
+                m.size = zip_get<std::uint32_t>(h + 24);
+                std::size_t name_len = zip_get<std::uint16_t>(h + 28);
+                std::size_t extra_len = zip_get<std::uint16_t>(h + 30);
+                std::size_t comment_len = zip_get<std::uint16_t>(h + 32);
+                m.offset = zip_get<std::uint32_t>(h + 42);
+                if (pos + zip_central_header_size + name_len + extra_len + comment_len > cd.size())
+                {
+                    XTENSOR_THROW(std::runtime_error, "invalid zip central directory");
+                }
+                m.name.assign(h + zip_central_header_size, name_len);
+
+                // the zip64 extra field holds, in order, the fields saturated in the header
+                const char* extra = h + zip_central_header_size + name_len;
+                for (std::size_t e = 0; e + 4 <= extra_len;)
+                {
+                    std::uint16_t id = zip_get<std::uint16_t>(extra + e);
+                    std::size_t len = zip_get<std::uint16_t>(extra + e + 2);
+                    if (id == zip64_extra_id)
+                    {
+                        const char* f = extra + e + 4;
+                        const char* f_end = f + (std::min)(len, extra_len - e - 4);
+                        for (std::uint64_t* field : {&m.size, &m.compressed_size, &m.offset})
+                        {
+                            if (*field == zip_max32 && f + 8 <= f_end)
+                            {
+                                *field = zip_get<std::uint64_t>(f);
+                                f += 8;
+                            }
+                        }
+                    }
+                    e += 4 + len;
+                }
+
+                members.push_back(std::move(m));
+                pos += zip_central_header_size + name_len + extra_len + comment_len;
+            }
+            return members;
+        }
+
+        // Offset of the data of a member, right after its local header
+        inline std::size_t zip_member_data_offset(positioned_file& file, const zip_member& member)
+        {
+            char local[zip_local_header_size];
+            file.read(local, zip_local_header_size, member.offset);
+            if (zip_get<std::uint32_t>(local) != zip_local_signature)
+            {
+                XTENSOR_THROW(std::runtime_error, "invalid zip local header");
+            }
+            return member.offset + zip_local_header_size
+                + zip_get<std::uint16_t>(local + 26) + zip_get<std::uint16_t>(local + 28);
+        }
+
+        /**
+         * Writes a stored member made of the concatenation of head and data at
+         * offset, which must be the current position of out. The local header is
+         * padded so that data is aligned on npz_alignment in the file.
+         */
+        template <class O>
+        inline zip_member write_zip_member(O& out, std::size_t offset, const std::string& name,
+                                           const std::string& head, const char* data, std::size_t data_size)
+        {
+            zip_member m;
+            m.name = name;
+            m.method = 0;
+            m.offset = offset;
+            m.size = head.size() + data_size;
+            m.compressed_size = m.size;
+            m.crc = crc32(crc32(0, head.data(), head.size()), data, data_size);
+
+            bool zip64 = m.size >= zip_max32;
+            std::string extra;
+            if (zip64)
+            {
+                zip_put(extra, zip64_extra_id);
+                zip_put(extra, std::uint16_t(16));
+                zip_put(extra, m.size);
+                zip_put(extra, m.compressed_size);
+            }
+            std::size_t unaligned = offset + zip_local_header_size + name.size() + extra.size() + 6 + head.size();
+            std::size_t padding = (npz_alignment - unaligned % npz_alignment) % npz_alignment;
+            zip_put(extra, zip_alignment_extra_id);
+            zip_put(extra, static_cast<std::uint16_t>(2 + padding));
+            zip_put(extra, static_cast<std::uint16_t>(npz_alignment));
+            extra.append(padding, '\0');
+
+            std::string local;
+            zip_put(local, zip_local_signature);
+            zip_put(local, std::uint16_t(zip64 ? 45 : 20));
+            zip_put(local, std::uint16_t(0));
+            zip_put(local, m.method);
+            // 1980-01-01 00:00, for reproducible archives
+            zip_put(local, std::uint16_t(0));
+            zip_put(local, std::uint16_t(0x21));
+            zip_put(local, m.crc);
+            zip_put(local, static_cast<std::uint32_t>(zip64 ? zip_max32 : m.compressed_size));
+            zip_put(local, static_cast<std::uint32_t>(zip64 ? zip_max32 : m.size));
+            zip_put(local, static_cast<std::uint16_t>(name.size()));
+            zip_put(local, static_cast<std::uint16_t>(extra.size()));
+            local += name;
+            local += extra;
+
+            out.write(local.data(), std::streamsize(local.size()));
+            out.write(head.data(), std::streamsize(head.size()));
+            out.write(data, std::streamsize(data_size));
+            return m;
+        }
+
+        // Writes the central directory at offset, the current position of out
+        template <class O>
+        inline void write_zip_directory(O& out, std::uint64_t offset, const std::vector<zip_member>& members)
+        {
+            std::string cd;
+            for (const auto& m : members)
+            {
+                std::string extra;
+                for (std::uint64_t field : {m.size, m.compressed_size, m.offset})
+                {
+                    if (field >= zip_max32)
+                    {
+                        zip_put(extra, field);
+                    }
+                }
+                if (!extra.empty())
+                {
+                    std::string header;
+                    zip_put(header, zip64_extra_id);
+                    zip_put(header, static_cast<std::uint16_t>(extra.size()));
+                    extra = header + extra;
+                }
+                bool zip64 = !extra.empty();
+
+                zip_put(cd, zip_central_signature);
+                // made by unix, for the external attributes
+                zip_put(cd, std::uint16_t((3 << 8) | (zip64 ? 45 : 20)));
+                zip_put(cd, std::uint16_t(zip64 ? 45 : 20));
+                zip_put(cd, std::uint16_t(0));
+                zip_put(cd, m.method);
+                zip_put(cd, std::uint16_t(0));
+                zip_put(cd, std::uint16_t(0x21));
+                zip_put(cd, m.crc);
+                zip_put(cd, static_cast<std::uint32_t>((std::min)(m.compressed_size, zip_max32)));
+                zip_put(cd, static_cast<std::uint32_t>((std::min)(m.size, zip_max32)));
+                zip_put(cd, static_cast<std::uint16_t>(m.name.size()));
+                zip_put(cd, static_cast<std::uint16_t>(extra.size()));
+                zip_put(cd, std::uint16_t(0));
+                zip_put(cd, std::uint16_t(0));
+                zip_put(cd, std::uint16_t(0));
+                // -rw-------
+                zip_put(cd, std::uint32_t(0600) << 16);
+                zip_put(cd, static_cast<std::uint32_t>((std::min)(m.offset, zip_max32)));
+                cd += m.name;
+                cd += extra;
+            }
+
+            std::uint64_t n_entries = members.size();
+            std::uint64_t cd_size = cd.size();
+            if (n_entries >= zip_max16 || cd_size >= zip_max32 || offset >= zip_max32)
+            {
+                std::uint64_t end64_offset = offset + cd_size;
+                zip_put(cd, zip64_end_signature);
+                zip_put(cd, std::uint64_t(zip64_end_size - 12));
+                zip_put(cd, std::uint16_t((3 << 8) | 45));
+                zip_put(cd, std::uint16_t(45));
+                zip_put(cd, std::uint32_t(0));
+                zip_put(cd, std::uint32_t(0));
+                zip_put(cd, n_entries);
+                zip_put(cd, n_entries);
+                zip_put(cd, cd_size);
+                zip_put(cd, offset);
+
+                zip_put(cd, zip64_locator_signature);
+                zip_put(cd, std::uint32_t(0));
+                zip_put(cd, end64_offset);
+                zip_put(cd, std::uint32_t(1));
+            }
+
+            zip_put(cd, zip_end_signature);
+            zip_put(cd, std::uint16_t(0));
+            zip_put(cd, std::uint16_t(0));
+            zip_put(cd, static_cast<std::uint16_t>((std::min)(n_entries, std::uint64_t(zip_max16))));
+            zip_put(cd, static_cast<std::uint16_t>((std::min)(n_entries, std::uint64_t(zip_max16))));
+            zip_put(cd, static_cast<std::uint32_t>((std::min)(cd_size, zip_max32)));
+            zip_put(cd, static_cast<std::uint32_t>((std::min)(offset, zip_max32)));
+            zip_put(cd, std::uint16_t(0));
+
+            out.write(cd.data(), std::streamsize(cd.size()));
+        }
+
+        inline npy_header read_npy_header(positioned_file& file, std::size_t offset)
+        {
+            // magic string, version and length of the header
+            char prefix[magic_string_length + 2 + 4];
+            file.read(prefix, magic_string_length + 2 + 2, offset);
+            std::size_t header_len;
+            if (prefix[magic_string_length] == 2)
+            {
+                file.read(prefix + magic_string_length + 4, 2, offset + magic_string_length + 4);
+                header_len = magic_string_length + 2 + 4 + zip_get<std::uint32_t>(prefix + magic_string_length + 2);
+            }
+            else
+            {
+                header_len = magic_string_length + 2 + 2 + zip_get<std::uint16_t>(prefix + magic_string_length + 2);
+            }
+            std::string header(header_len, '\0');
+            file.read(&header[0], header_len, offset);
+            std::istringstream stream(header);
+            return read_npy_header(stream);
+        }
+
+        /**
+         * Adapts the data of the npy content starting at npy_start in a file
+         * mapped in memory, read-only if T is const and copy-on-write otherwise.
+         * Data that is not aligned for T is copied.
+         */
+        template <class T, layout_type L>
+        inline auto map_npy(const std::string& filename, std::size_t npy_start, const npy_header& header)
+        {
+            using value_type = std::remove_const_t<T>;
+
+            if (header.typestring != build_typestring<value_type>())
+            {
+                XTENSOR_THROW(std::runtime_error,
+                              "Cast error: formats not matching "s + header.typestring +
+                              " vs "s + build_typestring<value_type>());
+            }
+
+            layout_type file_layout = header.fortran_order ? layout_type::column_major : layout_type::row_major;
+            if (L != layout_type::dynamic && L != file_layout)
+            {
+                XTENSOR_THROW(std::runtime_error, "Cast error: layout mismatch between npy file and requested layout.");
+            }
+
+            auto file = std::make_shared<mapped_file>(filename, !std::is_const<T>::value);
+            std::size_t n_bytes = compute_size(header.shape) * sizeof(value_type);
+            if (npy_start + header.offset + n_bytes > file->size())
+            {
+                XTENSOR_THROW(std::runtime_error, "io error: npy file is truncated.");
+            }
+
+            char* data = file->data() + npy_start + header.offset;
+            std::shared_ptr<void> owner = std::move(file);
+            if (reinterpret_cast<std::uintptr_t>(data) % alignof(value_type) != 0)
+            {
+                std::shared_ptr<char> buffer(new char[n_bytes], std::default_delete<char[]>());
+                std::memcpy(buffer.get(), data, n_bytes);
+                data = buffer.get();
+                owner = std::move(buffer);
+            }
+
+            return adapt_smart_ptr<L>(reinterpret_cast<T*>(data), header.shape, std::move(owner), file_layout);
+        }
+
+        template <class O, class E>
+        inline void dump_npy_stream(O& stream, const xexpression<E>& e)
+        {
+            using value_type = typename E::value_type;
+            const E& ex = e.derived_cast();
+            auto&& eval_ex = eval(ex);
+            bool fortran_order = false;
+            if (eval_ex.layout() == layout_type::column_major && eval_ex.dimension() > 1)
+            {
+                fortran_order = true;
+            }
+
+            std::string typestring = detail::build_typestring<value_type>();
+
+            auto shape = eval_ex.shape();
+            detail::write_header(stream, typestring, fortran_order, shape);
+
+            std::size_t size = compute_size(shape);
+            stream.write(reinterpret_cast<const char*>(eval_ex.data()),
+                         std::streamsize((sizeof(value_type) * size)));
+        }
+    }  // namespace detail
+
+    /**************************
+     * npy_writer declaration *
+     **************************/
+
+    /**
+     * @class npy_writer
+     * @brief Writes a npy file (the numpy storage format) row block by row block.
+     *
+     * The npy_writer class writes an array whose first dimension is not known
+     * upfront. Blocks of rows are appended along the first axis through a write
+     * buffer, so that the whole array never needs to be in memory. The header
+     * is written with room for any number of rows, and the actual shape is
+     * written to it when the writer is closed.
+     *
+     * \code{.cpp}
+     * xt::npy_writer<double> writer("out.npy", {3});
+     * for (std::size_t i = 0; i < 1000; ++i)
+     * {
+     *     writer.append(compute_rows(i));  // shape {n, 3}
+     * }
+     * writer.close();
+     * \endcode
+     *
+     * @tparam T The value type of the array.
+     */
+    template <class T>
+    class npy_writer
+    {
+    public:
+
+        using value_type = T;
+        using size_type = std::size_t;
+        using shape_type = std::vector<std::size_t>;
+
+        npy_writer(const std::string& filename, shape_type row_shape = {},
+                   size_type buffer_size = std::size_t(1) << 22);
+        ~npy_writer();
+
+        npy_writer(const npy_writer&) = delete;
+        npy_writer& operator=(const npy_writer&) = delete;
+
+        template <class E>
+        void append(const xexpression<E>& e);
+
+        void close();
+
+        size_type rows() const noexcept;
+        const shape_type& row_shape() const noexcept;
+
+    private:
+
+        shape_type file_shape(size_type rows) const;
+        void write(const char* data, size_type size);
+        void flush();
+
+        std::ofstream m_stream;
+        shape_type m_row_shape;
+        size_type m_row_size;
+        size_type m_rows;
+        size_type m_header_len;
+        unsigned char m_version;
+        std::vector<char> m_buffer;
+        size_type m_buffer_pos;
+        bool m_open;
+    };
+
+    /*****************************
+     * npy_writer implementation *
+     *****************************/
+
+    /**
+     * Creates the file and writes its header.
+     * @param filename The filename or path of the file to write
+     * @param row_shape The shape of the array, without its first dimension
+     * @param buffer_size The size of the write buffer in bytes
+     */
+    template <class T>
+    inline npy_writer<T>::npy_writer(const std::string& filename, shape_type row_shape, size_type buffer_size)
+        : m_stream(filename, std::ofstream::binary),
+          m_row_shape(std::move(row_shape)),
+          m_row_size(compute_size(m_row_shape)),
+          m_rows(0),
+          m_buffer(buffer_size),
+          m_buffer_pos(0),
+          m_open(true)
+    {
+        if (!m_stream)
+        {
+            XTENSOR_THROW(std::runtime_error, "IO Error: failed to open file: "s + filename);
+        }
+
+        // reserve room for the largest possible number of rows
+        std::string dict = detail::build_header_dict(detail::build_typestring<T>(), false,
+                                                     file_shape(std::numeric_limits<size_type>::max()));
+        m_header_len = detail::header_total_length(dict.size(), m_version);
+        detail::write_header_block(m_stream, detail::build_header_dict(detail::build_typestring<T>(), false, file_shape(0)),
+                                   m_version, m_header_len);
+    }
+
+    /**
+     * Closes the file if close has not been called.
+     */
+    template <class T>
+    inline npy_writer<T>::~npy_writer()
+    {
+        if (m_open)
+        {
+            try
+            {
+                close();
+            }
+            catch (...)
+            {
+            }
+        }
+    }
+
+    /**
+     * Appends rows to the array.
+     * @param e An expression of shape row_shape for a single row, or of
+     *          shape ``{n, row_shape...}`` for n rows
+     */
+    template <class T>
+    template <class E>
+    inline void npy_writer<T>::append(const xexpression<E>& e)
+    {
+        if (!m_open)
+        {
+            XTENSOR_THROW(std::runtime_error, "npy_writer: append to a closed writer");
+        }
+
+        const E& ex = e.derived_cast();
+        const auto& shape = ex.shape();
+        std::size_t dim = ex.dimension();
+        bool single_row = dim == m_row_shape.size();
+        if (!single_row && dim != m_row_shape.size() + 1)
+        {
+            XTENSOR_THROW(std::runtime_error, "npy_writer: shape mismatch");
+        }
+        if (!std::equal(m_row_shape.cbegin(), m_row_shape.cend(), shape.cbegin() + (single_row ? 0 : 1)))
+        {
+            XTENSOR_THROW(std::runtime_error, "npy_writer: shape mismatch");
+        }
+        std::size_t n_rows = single_row ? std::size_t(1) : static_cast<std::size_t>(shape[0]);
+
+        auto&& eval_ex = eval(ex);
+        if (std::is_same<typename E::value_type, T>::value && eval_ex.layout() == layout_type::row_major)
+        {
+            write(reinterpret_cast<const char*>(eval_ex.data()), n_rows * m_row_size * sizeof(T));
+        }
+        else
+        {
+            xarray<T, layout_type::row_major> tmp = eval_ex;
+            write(reinterpret_cast<const char*>(tmp.data()), n_rows * m_row_size * sizeof(T));
+        }
+        m_rows += n_rows;
+    }
+
+    /**
+     * Writes the buffered rows and the final shape, and closes the file.
+     */
+    template <class T>
+    inline void npy_writer<T>::close()
+    {
+        if (!m_open)
+        {
+            return;
+        }
+        m_open = false;
+
+        flush();
+        m_stream.seekp(0);
+        detail::write_header_block(m_stream, detail::build_header_dict(detail::build_typestring<T>(), false, file_shape(m_rows)),
+                                   m_version, m_header_len);
+        m_stream.close();
+        if (!m_stream)
+        {
+            XTENSOR_THROW(std::runtime_error, "io error: failed writing file");
+        }
+    }
+
+    /**
+     * Returns the number of rows appended so far.
+     */
+    template <class T>
+    inline auto npy_writer<T>::rows() const noexcept -> size_type
+    {
+        return m_rows;
+    }
+
+    /**
+     * Returns the shape of a row.
+     */
+    template <class T>
+    inline auto npy_writer<T>::row_shape() const noexcept -> const shape_type&
+    {
+        return m_row_shape;
+    }
+
+    template <class T>
+    inline auto npy_writer<T>::file_shape(size_type rows) const -> shape_type
+    {
+        shape_type shape(m_row_shape.size() + 1);
+        shape[0] = rows;
+        std::copy(m_row_shape.cbegin(), m_row_shape.cend(), shape.begin() + 1);
+        return shape;
+    }
+
+    template <class T>
+    inline void npy_writer<T>::write(const char* data, size_type size)
+    {
+        if (m_buffer_pos + size > m_buffer.size())
+        {
+            flush();
+        }
+        // blocks larger than the buffer are written directly
+        if (size >= m_buffer.size())
+        {
+            m_stream.write(data, std::streamsize(size));
+        }
+        else
+        {
+            std::memcpy(m_buffer.data() + m_buffer_pos, data, size);
+            m_buffer_pos += size;
+        }
+        if (!m_stream)
+        {
+            XTENSOR_THROW(std::runtime_error, "io error: failed writing file");
+        }
+    }
+
+    template <class T>
+    inline void npy_writer<T>::flush()
+    {
+        m_stream.write(m_buffer.data(), std::streamsize(m_buffer_pos));
+        m_buffer_pos = 0;
+    }
+
+
+
+    /**
+     * Save xexpression to NumPy npy format
+     *
+     * @param filename The filename or path to dump the data
+     * @param e the xexpression
+     */
+    template <typename E>
+    inline void dump_npy(const std::string& filename, const xexpression<E>& e)
+    {
+        std::ofstream stream(filename, std::ofstream::binary);
+        if (!stream)
+        {
+            XTENSOR_THROW(std::runtime_error, "IO Error: failed to open file: "s + filename);
+        }
+
+        detail::dump_npy_stream(stream, e);
+    }
+
+    /**
+     * Save xexpression to NumPy npy format in a string
+     *
+     * @param e the xexpression
+     */
+    template <typename E>
+    inline std::string dump_npy(const xexpression<E>& e)
+    {
+        std::stringstream stream;
+        detail::dump_npy_stream(stream, e);
+        return stream.str();
+    }
+
+    /**
+     * Loads a npy file (the numpy storage format)
+     *
+     * @param stream An input stream from which to load the file
+     * @tparam T select the type of the npy file (note: currently there is
+     *           no dynamic casting if types do not match)
+     * @tparam L select layout_type::column_major if you stored data in
+     *           Fortran format
+     * @return xarray with contents from npy file
+     */
+    template <typename T, layout_type L = layout_type::dynamic>
+    inline auto load_npy(std::istream& stream)
+    {
+        detail::npy_file file = detail::load_npy_file(stream);
+        return std::move(file).cast<T, L>();
+    }
+
+    /**
+     * Loads a npy file (the numpy storage format)
+     *
+     * @param filename The filename or path to the file
+     * @tparam T select the type of the npy file (note: currently there is
+     *           no dynamic casting if types do not match)
+     * @tparam L select layout_type::column_major if you stored data in
+     *           Fortran format
+     * @return xarray with contents from npy file
+     */
+    template <typename T, layout_type L = layout_type::dynamic>
+    inline auto load_npy(const std::string& filename)
+    {
+        std::ifstream stream(filename, std::ifstream::binary);
+        if (!stream)
+        {
+            XTENSOR_THROW(std::runtime_error, "io error: failed to open a file.");
+        }
+        return load_npy<T, L>(stream);
+    }
+
+    /**
+     * Maps a npy file (the numpy storage format) in memory
+     *
+     * Nothing but the header is read: the returned adaptor refers to the data
+     * of the file, which is paged in on demand. With a const value type (e.g.
+     * ``load_npy_mmap<const double>``) the mapping is read-only. Otherwise it is
+     * copy-on-write: the contents can be modified, but the file is left
+     * untouched. The mapping is released when the last copy of the adaptor
+     * is destroyed. Data that is not aligned for the value type, which numpy
+     * never writes, is copied.
+     *
+     * @param filename The filename or path to the file
+     * @tparam T select the type of the npy file, which must match the file
+     *           exactly since no conversion is possible
+     * @tparam L select layout_type::column_major if you stored data in
+     *           Fortran format
+     * @return xarray_adaptor on the mapped data
+     */
+    template <typename T, layout_type L = layout_type::dynamic>
+    inline auto load_npy_mmap(const std::string& filename)
+    {
+        detail::npy_header header;
+        {
+            std::ifstream stream(filename, std::ifstream::binary);
+            if (!stream)
+            {
+                XTENSOR_THROW(std::runtime_error, "io error: failed to open a file.");
+            }
+            header = detail::read_npy_header(stream);
+        }
+
+        return detail::map_npy<T, L>(filename, 0, header);
+    }
+
+    /**
+     * Loads a slice of a npy file (the numpy storage format)
+     *
+     * Only the header and the selected elements are read from the file: the
+     * selected bytes are read with positioned reads, contiguous and nearby
+     * ranges being merged. Slices are given as for view: integers, ``range``,
+     * ``all`` and ``keep`` / ``drop`` are supported, missing trailing slices
+     * select the whole dimension.
+     *
+     * \code{.cpp}
+     * // rows 100 to 199 of the second column
+     * auto col = xt::load_npy_slice<double>("in.npy", xt::range(100, 200), 1);
+     * \endcode
+     *
+     * @param filename The filename or path to the file
+     * @param slices The slices selecting the elements to load
+     * @tparam T select the type of the npy file (note: currently there is
+     *           no dynamic casting if types do not match)
+     * @tparam L select layout_type::column_major if you stored data in
+     *           Fortran format
+     * @return xarray with the selected contents of the npy file
+     */
+    template <typename T, layout_type L = layout_type::dynamic, class... S>
+    inline auto load_npy_slice(const std::string& filename, S&&... slices)
+    {
+        detail::npy_header header;
+        {
+            std::ifstream stream(filename, std::ifstream::binary);
+            if (!stream)
+            {
+                XTENSOR_THROW(std::runtime_error, "io error: failed to open a file.");
+            }
+            header = detail::read_npy_header(stream);
+        }
+
+        if (header.typestring != detail::build_typestring<T>())
+        {
+            XTENSOR_THROW(std::runtime_error,
+                          "Cast error: formats not matching "s + header.typestring +
+                          " vs "s + detail::build_typestring<T>());
+        }
+
+        layout_type file_layout = header.fortran_order ? layout_type::column_major : layout_type::row_major;
+        if (L != layout_type::dynamic && L != file_layout)
+        {
+            XTENSOR_THROW(std::runtime_error, "Cast error: layout mismatch between npy file and requested layout.");
+        }
+
+        if (sizeof...(S) > header.shape.size())
+        {
+            XTENSOR_THROW(std::runtime_error, "npy slice: too many slices for the array dimension");
+        }
+
+        detail::npy_slice_shape e{header.shape};
+        std::vector<detail::npy_slice_dim> dims;
+        dims.reserve(header.shape.size());
+        std::size_t dim = 0;
+        int expand[] = {0, (dims.push_back(detail::make_npy_slice_dim(e, std::forward<S>(slices), dim++)), 0)...};
+        (void)expand;
+        for (; dim < header.shape.size(); ++dim)
+        {
+            detail::npy_slice_dim all{std::vector<std::size_t>(header.shape[dim]), true};
+            std::iota(all.indices.begin(), all.indices.end(), std::size_t(0));
+            dims.push_back(std::move(all));
+        }
+
+        std::vector<std::size_t> shape;
+        for (const auto& d : dims)
+        {
+            if (d.keep)
+            {
+                shape.push_back(d.indices.size());
+            }
+        }
+
+        xarray<T, L> result;
+        result.resize(shape, file_layout);
+
+        // the selected elements are read in storage order of the file,
+        // which is the storage order of the result
+        std::vector<std::size_t> storage_shape(header.shape);
+        if (header.fortran_order)
+        {
+            std::reverse(storage_shape.begin(), storage_shape.end());
+            std::reverse(dims.begin(), dims.end());
+        }
+
+        detail::positioned_file file(filename);
+        detail::read_npy_slice(file, header.offset, storage_shape, dims, sizeof(T),
+                               reinterpret_cast<char*>(result.data()));
+        return result;
+    }
+
+    /************************
+     * npz_file declaration *
+     ************************/
+
+    /**
+     * @class npz_file
+     * @brief Lazy reader of a npz file (the numpy archive format).
+     *
+     * Opening a npz_file only reads the directory of the archive. The arrays are
+     * read when they are requested by name: stored members are mapped in memory
+     * (see load_npy_mmap), so that accessing an array does not read the others.
+     * Compressed members (written by ``numpy.savez_compressed``) are not supported.
+     */
+    class npz_file
+    {
+    public:
+
+        explicit npz_file(const std::string& filename);
+
+        std::vector<std::string> names() const;
+        bool contains(const std::string& name) const;
+
+        template <class T, layout_type L = layout_type::dynamic>
+        auto get(const std::string& name) const;
+
+    private:
+
+        std::string m_filename;
+        std::map<std::string, detail::zip_member> m_members;
+    };
+
+    /***************************
+     * npz_file implementation *
+     ***************************/
+
+    /**
+     * Reads the directory of a npz file.
+     * @param filename The filename or path to the file
+     */
+    inline npz_file::npz_file(const std::string& filename)
+        : m_filename(filename)
+    {
+        detail::positioned_file file(filename);
+        std::size_t cd_offset;
+        for (auto& member : detail::read_zip_directory(file, cd_offset))
+        {
+            std::string name = member.name;
+            // numpy names the members after the arrays, with the npy extension
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".npy") == 0)
+            {
+                name.erase(name.size() - 4);
+            }
+            m_members.emplace(std::move(name), std::move(member));
+        }
+    }
+
+    /**
+     * Returns the names of the arrays of the archive.
+     */
+    inline std::vector<std::string> npz_file::names() const
+    {
+        std::vector<std::string> res;
+        res.reserve(m_members.size());
+        for (const auto& member : m_members)
+        {
+            res.push_back(member.first);
+        }
+        return res;
+    }
+
+    /**
+     * Returns true if the archive contains an array with the given name.
+     */
+    inline bool npz_file::contains(const std::string& name) const
+    {
+        return m_members.find(name) != m_members.end();
+    }
+
+    /**
+     * Maps an array of the archive in memory.
+     * @param name The name of the array
+     * @tparam T select the type of the array, const for a read-only mapping
+     * @tparam L select layout_type::column_major if the array was stored in
+     *           Fortran format
+     * @return xarray_adaptor on the mapped data
+     */
+    template <class T, layout_type L>
+    inline auto npz_file::get(const std::string& name) const
+    {
+        auto it = m_members.find(name);
+        if (it == m_members.end())
+        {
+            XTENSOR_THROW(std::runtime_error, "npz: no array named "s + name);
+        }
+        if (it->second.method != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "npz: compressed arrays are not supported");
+        }
+
+        detail::positioned_file file(m_filename);
+        std::size_t npy_start = detail::zip_member_data_offset(file, it->second);
+        detail::npy_header header = detail::read_npy_header(file, npy_start);
+        return detail::map_npy<T, L>(m_filename, npy_start, header);
+    }
+
+    /**
+     * Opens a npz file (the numpy archive format). Only the directory of the
+     * archive is read, see npz_file.
+     *
+     * @param filename The filename or path to the file
+     * @return npz_file giving access to the arrays of the archive
+     */
+    inline npz_file load_npz(const std::string& filename)
+    {
+        return npz_file(filename);
+    }
+
+    /**
+     * Loads an array from a npz file (the numpy archive format)
+     *
+     * @param filename The filename or path to the file
+     * @param name The name of the array
+     * @tparam T select the type of the array, const for a read-only mapping
+     * @tparam L select layout_type::column_major if the array was stored in
+     *           Fortran format
+     * @return xarray_adaptor on the mapped data
+     */
+    template <typename T, layout_type L = layout_type::dynamic>
+    inline auto load_npz(const std::string& filename, const std::string& name)
+    {
+        return npz_file(filename).get<T, L>(name);
+    }
+
+    /**
+     * Save xexpression to a npz file (the numpy archive format)
+     *
+     * The array is stored uncompressed, with its data aligned in the file so
+     * that it can be mapped in memory when loaded.
+     *
+     * @param filename The filename or path to the file
+     * @param name The name of the array in the archive
+     * @param e the xexpression
+     * @param append If true, the array is added to the archive if the file
+     *               exists, otherwise the file is overwritten [default: true]
+     */
+    template <typename E>
+    inline void dump_npz(const std::string& filename, const std::string& name,
+                         const xexpression<E>& e, bool append = true)
+    {
+        using value_type = typename E::value_type;
+
+        std::string member_name = name + ".npy";
+        std::vector<detail::zip_member> members;
+        std::size_t offset = 0;
+        bool exists = append && std::ifstream(filename).good();
+        if (exists)
+        {
+            detail::positioned_file file(filename);
+            members = detail::read_zip_directory(file, offset);
+            for (const auto& member : members)
+            {
+                if (member.name == member_name)
+                {
+                    XTENSOR_THROW(std::runtime_error, "npz: the archive already contains an array named "s + name);
+                }
+            }
+        }
+
+        // the new member overwrites the central directory, which is written
+        // again after it, hence the file can only grow
+        std::fstream stream(filename, exists ? std::ios::in | std::ios::out | std::ios::binary
+                                             : std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!stream)
+        {
+            XTENSOR_THROW(std::runtime_error, "IO Error: failed to open file: "s + filename);
+        }
+        stream.seekp(std::streamoff(offset));
+
+        auto&& eval_ex = eval(e.derived_cast());
+        bool fortran_order = eval_ex.layout() == layout_type::column_major && eval_ex.dimension() > 1;
+        std::ostringstream head;
+        detail::write_header(head, detail::build_typestring<value_type>(), fortran_order, eval_ex.shape());
+
+        members.push_back(detail::write_zip_member(stream, offset, member_name, head.str(),
+                                                   reinterpret_cast<const char*>(eval_ex.data()),
+                                                   sizeof(value_type) * eval_ex.size()));
+        auto cd_offset = static_cast<std::size_t>(stream.tellp());
+        detail::write_zip_directory(stream, cd_offset, members);
+        if (!stream)
+        {
+            XTENSOR_THROW(std::runtime_error, "io error: failed writing file");
         }
-        return load_npy<T, L>(stream);
     }
 
 }  // namespace xt
@@ -18,12 +18,14 @@
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <xtl/xfunctional.hpp>
 #include <xtl/xsequence.hpp>
 
 #include "xaccessible.hpp"
 #include "xbuilder.hpp"
+#include "xchunked_assign.hpp"
 #include "xeval.hpp"
 #include "xexpression.hpp"
 #include "xgenerator.hpp"
@@ -503,6 +505,183 @@ namespace xt
     }
 
 
+    namespace detail
+    {
+        /**
+         * Reduces a chunked array: every chunk is reduced with the immediate
+         * kernel, in parallel when the chunks can be accessed concurrently, then
+         * the partial results of the chunks lying along the reduced axes are
+         * combined with the merge function.
+         */
+        template <class F, class E, class X, class O>
+        inline auto reduce_chunked(F&& f, const E& e, const X& axes, O&& raw_options)
+        {
+            using reduce_functor_type = typename std::decay_t<F>::reduce_functor_type;
+            using init_functor_type = typename std::decay_t<F>::init_functor_type;
+            using expr_value_type = typename E::value_type;
+            using result_type = std::decay_t<decltype(std::declval<reduce_functor_type>()(std::declval<init_functor_type>()(), std::declval<expr_value_type>()))>;
+
+            using options_t = reducer_options<result_type, std::decay_t<O>>;
+            options_t options(raw_options);
+
+            using shape_type = typename xreducer_shape_type<typename E::shape_type, X, typename options_t::keep_dims>::type;
+            using result_container_type = typename detail::xtype_for_shape<shape_type>::template type<result_type, XTENSOR_DEFAULT_LAYOUT>;
+
+            using chunk_type = typename E::chunk_type;
+            using chunk_options_type = std::tuple<evaluation_strategy::immediate_type, keep_dims_type>;
+            using partial_type = decltype(reduce_immediate(f, std::declval<const chunk_type&>(), axes, chunk_options_type()));
+
+            if (!std::is_sorted(axes.cbegin(), axes.cend(), std::less_equal<>()))
+            {
+                XTENSOR_THROW(std::runtime_error, "Reducing axes should be sorted and should not contain duplicates");
+            }
+            if (axes.size() != 0 && axes[axes.size() - 1] > e.dimension() - 1)
+            {
+                XTENSOR_THROW(std::runtime_error,
+                              "Axis " + std::to_string(axes[axes.size() - 1]) +
+                              " out of bounds for reduction.");
+            }
+
+            const std::size_t dim = e.dimension();
+            std::vector<bool> reduced(dim, false);
+            for (auto ax : axes)
+            {
+                reduced[ax] = true;
+            }
+
+            shape_type result_shape{};
+            resize_container(result_shape, typename options_t::keep_dims() ? dim : dim - axes.size());
+            for (std::size_t i = 0, idx = 0; i < dim; ++i)
+            {
+                if (!reduced[i])
+                {
+                    result_shape[idx++] = e.shape()[i];
+                }
+                else if (typename options_t::keep_dims())
+                {
+                    result_shape[idx++] = 1;
+                }
+            }
+            result_container_type result(result_shape);
+
+            // an empty array has no chunk to reduce
+            if (e.size() == 0)
+            {
+                result.fill(options_t::has_initial_value ? options.initial_value
+                                                         : static_cast<result_type>(xt::get<1>(f)()));
+                return result;
+            }
+
+            // row-major strides of the chunk grid
+            const auto& grid_shape = e.grid_shape();
+            std::vector<std::size_t> grid_strides(dim, 1);
+            for (std::size_t d = dim; d > 1; --d)
+            {
+                grid_strides[d - 2] = grid_strides[d - 1] * grid_shape[d - 1];
+            }
+            auto unravel = [&grid_strides](std::size_t i) {
+                std::vector<std::size_t> index(grid_strides.size());
+                for (std::size_t d = 0; d < index.size(); ++d)
+                {
+                    index[d] = i / grid_strides[d];
+                    i %= grid_strides[d];
+                }
+                return index;
+            };
+
+            std::vector<partial_type> partials(e.grid_size());
+            constexpr bool parallel = !has_serial_chunk_storage<E>::value;
+            for_each_chunk(e, parallel, [&](auto& it, std::size_t i) {
+                decltype(auto) chunk = *it;
+                auto index = unravel(i);
+                bool edge_chunk = false;
+                for (std::size_t d = 0; d < dim; ++d)
+                {
+                    edge_chunk = edge_chunk || (index[d] + 1) * e.chunk_shape()[d] > e.shape()[d];
+                }
+                if (edge_chunk)
+                {
+                    // only the part of an edge chunk inside the array holds valid values
+                    chunk_type valid = strided_view(chunk, it.get_chunk_slice_vector());
+                    partials[i] = reduce_immediate(f, valid, axes, chunk_options_type());
+                }
+                else
+                {
+                    partials[i] = reduce_immediate(f, chunk, axes, chunk_options_type());
+                }
+            });
+
+            // merge the partial results into the one of the first chunk along the reduced axes
+            auto merge_fct = xt::get<2>(f);
+            for (std::size_t i = 0; i < partials.size(); ++i)
+            {
+                auto index = unravel(i);
+                std::size_t target = i;
+                for (std::size_t d = 0; d < dim; ++d)
+                {
+                    if (reduced[d])
+                    {
+                        target -= index[d] * grid_strides[d];
+                    }
+                }
+                if (target != i)
+                {
+                    auto& acc = partials[target];
+                    std::transform(acc.storage().cbegin(), acc.storage().cend(),
+                                   partials[i].storage().cbegin(),
+                                   acc.storage().begin(), merge_fct);
+                    partials[i] = partial_type();
+                }
+            }
+
+            // Fast track for complete reduction
+            if (axes.size() == dim)
+            {
+                *(result.begin()) = *(partials[0].cbegin());
+            }
+            else
+            {
+                for (std::size_t i = 0; i < partials.size(); ++i)
+                {
+                    auto index = unravel(i);
+                    if (std::any_of(axes.cbegin(), axes.cend(), [&index](auto ax) { return index[ax] != 0; }))
+                    {
+                        continue;
+                    }
+                    xstrided_slice_vector result_slices;
+                    xstrided_slice_vector partial_slices(dim);
+                    for (std::size_t d = 0; d < dim; ++d)
+                    {
+                        if (!reduced[d])
+                        {
+                            std::size_t first = index[d] * e.chunk_shape()[d];
+                            result_slices.push_back(range(first, first + partials[i].shape()[d]));
+                            partial_slices[d] = all();
+                        }
+                        else if (typename options_t::keep_dims())
+                        {
+                            result_slices.push_back(all());
+                            partial_slices[d] = all();
+                        }
+                        else
+                        {
+                            partial_slices[d] = std::ptrdiff_t(0);
+                        }
+                    }
+                    noalias(strided_view(result, result_slices)) = strided_view(partials[i], partial_slices);
+                }
+            }
+
+            if (options_t::has_initial_value)
+            {
+                std::transform(result.data(), result.data() + result.size(), result.data(),
+                               [&merge_fct, &options](auto&& v) { return merge_fct(v, options.initial_value); });
+            }
+            return result;
+        }
+    }
+
+
     /*********************
      * xreducer functors *
      *********************/
@@ -844,7 +1023,8 @@ namespace xt
 
     namespace detail
     {
-        template <class F, class E, class X, class O>
+        template <class F, class E, class X, class O,
+                  XTL_REQUIRES(xtl::negation<is_xchunked_array<std::decay_t<E>>>)>
         inline auto reduce_impl(F&& f, E&& e, X&& axes, evaluation_strategy::lazy_type, O&& options)
         {
             decltype(auto) normalized_axes = normalize_axis(e, std::forward<X>(axes));
@@ -861,7 +1041,8 @@ namespace xt
         }
 
 
-        template <class F, class E, class X, class O>
+        template <class F, class E, class X, class O,
+                  XTL_REQUIRES(xtl::negation<is_xchunked_array<std::decay_t<E>>>)>
         inline auto reduce_impl(F&& f, E&& e, X&& axes, evaluation_strategy::immediate_type, O&& options)
         {
             decltype(auto) normalized_axes = normalize_axis(e, std::forward<X>(axes));
@@ -871,6 +1052,16 @@ namespace xt
                                     std::forward<O>(options)
             );
         }
+
+        // Chunked arrays are always reduced immediately, chunk by chunk,
+        // whatever the requested evaluation strategy.
+        template <class F, class E, class X, class S, class O,
+                  XTL_REQUIRES(is_xchunked_array<std::decay_t<E>>)>
+        inline auto reduce_impl(F&& f, E&& e, X&& axes, S, O&& options)
+        {
+            decltype(auto) normalized_axes = normalize_axis(e, std::forward<X>(axes));
+            return reduce_chunked(std::forward<F>(f), e, normalized_axes, std::forward<O>(options));
+        }
     }
 
 #define DEFAULT_STRATEGY_REDUCERS std::tuple<evaluation_strategy::lazy_type>
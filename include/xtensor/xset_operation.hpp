@@ -12,7 +12,10 @@
 
 #include <algorithm>
 #include <functional>
+#include <iterator>
+#include <memory>
 #include <type_traits>
+#include <vector>
 
 #include <xtl/xsequence.hpp>
 
@@ -22,33 +25,228 @@
 #include "xstrides.hpp"
 #include "xstrided_view.hpp"
 #include "xmath.hpp"
+#include "xsort.hpp"
+#include "xtensor_simd.hpp"
 
 namespace xt
 {
 
     namespace detail
     {
+        // Below this number of test elements, comparing against all of them
+        // (with a vectorized broadcast-compare when xsimd is enabled) is faster
+        // than probing a lookup structure.
+        constexpr std::size_t isin_linear_threshold = 16;
 
-        template <bool lvalue>
-        struct lambda_isin
+        template <class T, class = void_t<>>
+        struct is_less_than_comparable : std::false_type
         {
-            template <class E>
-            static auto make(E&& e)
+        };
+
+        template <class T>
+        struct is_less_than_comparable<T, void_t<decltype(std::declval<const T&>() < std::declval<const T&>())>>
+            : std::true_type
+        {
+        };
+
+        template <class T>
+        inline bool isin_linear(const std::vector<T>& values, const T& value) noexcept
+        {
+            // No early exit, so that the loop can be vectorized by the compiler
+            bool found = false;
+            for (std::size_t i = 0; i < values.size(); ++i)
+            {
+                found = static_cast<bool>(found | static_cast<bool>(values[i] == value));
+            }
+            return found;
+        }
+
+#ifdef XTENSOR_USE_XSIMD
+        template <class T>
+        inline std::enable_if_t<(xt_simd::simd_traits<T>::size > 1), bool>
+        isin_broadcast(const std::vector<T>& values, const T& value) noexcept
+        {
+            // values is padded to a multiple of the batch size
+            using batch_type = xt_simd::simd_type<T>;
+            constexpr std::size_t simd_size = xt_simd::simd_traits<T>::size;
+            const batch_type probe(value);
+            for (std::size_t i = 0; i < values.size(); i += simd_size)
+            {
+                if (xsimd::any(xsimd::load_unaligned(values.data() + i) == probe))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        template <class T>
+        inline std::enable_if_t<(xt_simd::simd_traits<T>::size <= 1), bool>
+        isin_broadcast(const std::vector<T>& values, const T& value) noexcept
+        {
+            return isin_linear(values, value);
+        }
+#else
+        template <class T>
+        inline bool isin_broadcast(const std::vector<T>& values, const T& value) noexcept
+        {
+            return isin_linear(values, value);
+        }
+#endif
+
+        struct isin_no_table
+        {
+        };
+
+        /**
+         * Set of test elements built once for isin and in1d. Small sets are
+         * searched linearly, arithmetic types are stored in a hash table and
+         * other ordered types in a sorted vector. Unordered, non arithmetic
+         * types fall back to a linear search.
+         */
+        template <class T>
+        class isin_lookup
+        {
+        public:
+
+            using value_type = T;
+
+            template <class It>
+            isin_lookup(It first, It last)
+                : m_method(method::linear)
+            {
+                for (; first != last; ++first)
+                {
+                    m_values.push_back(static_cast<value_type>(*first));
+                }
+                init(std::is_arithmetic<value_type>(), is_less_than_comparable<value_type>());
+            }
+
+            bool contains(const value_type& value) const
+            {
+                switch (m_method)
+                {
+                    case method::broadcast:
+                        return isin_broadcast(m_values, value);
+                    case method::hash:
+                        return contains_hash(value, std::is_arithmetic<value_type>());
+                    case method::sorted:
+                        return contains_sorted(value, is_less_than_comparable<value_type>());
+                    default:
+                        return std::find(m_values.cbegin(), m_values.cend(), value) != m_values.cend();
+                }
+            }
+
+        private:
+
+            enum class method
+            {
+                linear,
+                broadcast,
+                hash,
+                sorted
+            };
+
+            using table_type = std::conditional_t<std::is_arithmetic<value_type>::value,
+                                                  unique_hash_table<value_type>,
+                                                  isin_no_table>;
+
+            template <class B>
+            void init(std::true_type /*is_arithmetic*/, B)
+            {
+                if (m_values.size() <= isin_linear_threshold)
+                {
+                    init_broadcast();
+                }
+                else
+                {
+                    m_table = table_type(m_values.size());
+                    for (const auto& v : m_values)
+                    {
+                        m_table.insert(v);
+                    }
+                    m_values.clear();
+                    m_values.shrink_to_fit();
+                    m_method = method::hash;
+                }
+            }
+
+            void init(std::false_type /*is_arithmetic*/, std::true_type /*is_less_than_comparable*/)
+            {
+                if (m_values.size() > isin_linear_threshold)
+                {
+                    std::sort(m_values.begin(), m_values.end());
+                    m_method = method::sorted;
+                }
+            }
+
+            void init(std::false_type /*is_arithmetic*/, std::false_type /*is_less_than_comparable*/)
+            {
+            }
+
+            void init_broadcast()
+            {
+                if (!m_values.empty())
+                {
+                    // Pad with an already present value so that the broadcast-compare
+                    // runs on full batches only
+                    constexpr std::size_t simd_size = xt_simd::simd_traits<value_type>::size;
+                    std::size_t padded_size = (m_values.size() + simd_size - 1) / simd_size * simd_size;
+                    m_values.resize(padded_size, m_values.front());
+                }
+                m_method = method::broadcast;
+            }
+
+            bool contains_hash(const value_type& value, std::true_type /*is_arithmetic*/) const
+            {
+                return m_table.find(value) != table_type::npos;
+            }
+
+            bool contains_hash(const value_type&, std::false_type /*is_arithmetic*/) const
+            {
+                return false;
+            }
+
+            bool contains_sorted(const value_type& value, std::true_type /*is_less_than_comparable*/) const
             {
-                return [&e](const auto& t) { return std::find(e.begin(), e.end(), t) != e.end(); };
+                return std::binary_search(m_values.cbegin(), m_values.cend(), value);
             }
+
+            bool contains_sorted(const value_type&, std::false_type /*is_less_than_comparable*/) const
+            {
+                return false;
+            }
+
+            std::vector<value_type> m_values;
+            table_type m_table;
+            method m_method;
         };
 
-        template <>
-        struct lambda_isin<false>
+        /**
+         * Functor probing an isin_lookup. The lookup is shared so that copies of
+         * the resulting xfunction do not duplicate the set.
+         */
+        template <class T>
+        struct isin_fct
         {
-            template <class E>
-            static auto make(E&& e)
+            using lookup_type = isin_lookup<T>;
+
+            bool operator()(const T& value) const
             {
-                return [e](const auto& t) { return std::find(e.begin(), e.end(), t) != e.end(); };
+                return m_lookup->contains(value);
             }
+
+            std::shared_ptr<const lookup_type> m_lookup;
         };
 
+        template <class E, class T, class It>
+        inline auto make_isin(E&& element, It first, It last)
+        {
+            using value_type = std::common_type_t<typename std::decay_t<E>::value_type, T>;
+            using functor_type = isin_fct<value_type>;
+            functor_type fct{std::make_shared<const typename functor_type::lookup_type>(first, last)};
+            return make_lambda_xfunction(std::move(fct), std::forward<E>(element));
+        }
     }
 
     /**
@@ -57,52 +255,50 @@ namespace xt
     *
     * Returns a boolean array of the same shape as ``element`` that is ``true`` where an element of
     * ``element`` is in ``test_elements`` and ``False`` otherwise.
+    * The test elements are stored once in a lookup structure chosen according to their
+    * number and type (linear broadcast-compare for small sets, hash table or sorted vector
+    * for larger ones), which is then probed lazily for each element.
     * @param element an \ref xexpression
     * @param test_elements an array
     * @return a boolean array
     */
     template <class E, class T>
-    inline auto isin(E&& element, std::initializer_list<T> test_elements) noexcept
+    inline auto isin(E&& element, std::initializer_list<T> test_elements)
     {
-        auto lambda = [test_elements](const auto& t) {
-            return std::find(test_elements.begin(), test_elements.end(), t) != test_elements.end(); };
-        return make_lambda_xfunction(std::move(lambda), std::forward<E>(element));
+        return detail::make_isin<E, T>(std::forward<E>(element), test_elements.begin(), test_elements.end());
     }
 
     /**
     * @ingroup logical_operators
     * @brief isin
     *
-    * Returns a boolean array of the same shape as ``element`` that is ``true`` where an element of
-    * ``element`` is in ``test_elements`` and ``False`` otherwise.
+    * Same as isin(E&&, std::initializer_list<T>), with test elements held in a container.
     * @param element an \ref xexpression
     * @param test_elements an array
     * @return a boolean array
     */
     template <class E, class F, class = typename std::enable_if_t<has_iterator_interface<F>::value>>
-    inline auto isin(E&& element, F&& test_elements) noexcept
+    inline auto isin(E&& element, F&& test_elements)
     {
-        auto lambda = detail::lambda_isin<std::is_lvalue_reference<F>::value>::make(std::forward<F>(test_elements));
-        return make_lambda_xfunction(std::move(lambda), std::forward<E>(element));
+        using value_type = typename std::decay_t<F>::value_type;
+        return detail::make_isin<E, value_type>(std::forward<E>(element), test_elements.begin(), test_elements.end());
     }
 
     /**
     * @ingroup logical_operators
     * @brief isin
     *
-    * Returns a boolean array of the same shape as ``element`` that is ``true`` where an element of
-    * ``element`` is in ``test_elements`` and ``False`` otherwise.
+    * Same as isin(E&&, std::initializer_list<T>), with test elements given by a pair of iterators.
     * @param element an \ref xexpression
     * @param test_elements_begin iterator to the beginning of an array
     * @param test_elements_end iterator to the end of an array
     * @return a boolean array
     */
     template <class E, class I, class = typename std::enable_if_t<is_iterator<I>::value>>
-    inline auto isin(E&& element, I&& test_elements_begin, I&& test_elements_end) noexcept
+    inline auto isin(E&& element, I&& test_elements_begin, I&& test_elements_end)
     {
-        auto lambda = [&test_elements_begin, &test_elements_end](const auto& t) {
-            return std::find(test_elements_begin, test_elements_end, t) != test_elements_end; };
-        return make_lambda_xfunction(std::move(lambda), std::forward<E>(element));
+        using value_type = typename std::iterator_traits<std::decay_t<I>>::value_type;
+        return detail::make_isin<E, value_type>(std::forward<E>(element), test_elements_begin, test_elements_end);
     }
 
     /**
@@ -116,7 +312,7 @@ namespace xt
     * @return a boolean array
     */
     template <class E, class T>
-    inline auto in1d(E&& element, std::initializer_list<T> test_elements) noexcept
+    inline auto in1d(E&& element, std::initializer_list<T> test_elements)
     {
         XTENSOR_ASSERT(element.dimension() == 1ul);
         return isin(std::forward<E>(element), std::forward<std::initializer_list<T>>(test_elements));
@@ -133,7 +329,7 @@ namespace xt
     * @return a boolean array
     */
     template <class E, class F, class = typename std::enable_if_t<has_iterator_interface<F>::value>>
-    inline auto in1d(E&& element, F&& test_elements) noexcept
+    inline auto in1d(E&& element, F&& test_elements)
     {
         XTENSOR_ASSERT(element.dimension() == 1ul);
         XTENSOR_ASSERT(test_elements.dimension() == 1ul);
@@ -152,16 +348,115 @@ namespace xt
     * @return a boolean array
     */
     template <class E, class I, class = typename std::enable_if_t<is_iterator<I>::value>>
-    inline auto in1d(E&& element, I&& test_elements_begin, I&& test_elements_end) noexcept
+    inline auto in1d(E&& element, I&& test_elements_begin, I&& test_elements_end)
     {
         XTENSOR_ASSERT(element.dimension() == 1ul);
         return isin(std::forward<E>(element), std::forward<I>(test_elements_begin), std::forward<I>(test_elements_end));
     }
 
+    namespace detail
+    {
+        // Minimal number of values handled by a block when searchsorted runs in parallel
+        constexpr std::size_t searchsorted_grain_size = 4096;
+
+        template <class T>
+        inline void prefetch_read(const T* p) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(p);
+#else
+            (void) p;
+#endif
+        }
+
+        /**
+         * Branchless binary search in the sorted range [first, first + size).
+         * Returns the length of the leading part of the range for which
+         * cmp(element, value) holds. The loop body compiles to a conditional
+         * move instead of a hard to predict branch, and both candidates of the
+         * next iteration are prefetched to hide memory latency on large ranges.
+         */
+        template <class T, class V, class Cmp>
+        inline std::size_t branchless_bound(const T* first, std::size_t size, const V& value, Cmp cmp) noexcept
+        {
+            if (size == 0)
+            {
+                return 0;
+            }
+            const T* base = first;
+            std::size_t len = size;
+            while (len > 1)
+            {
+                std::size_t half = len / 2;
+                prefetch_read(base + half / 2);
+                prefetch_read(base + half + half / 2);
+                base = cmp(base[half], value) ? base + half : base;
+                len -= half;
+            }
+            return static_cast<std::size_t>(base - first) + static_cast<std::size_t>(cmp(*base, value));
+        }
+
+        /**
+         * Same as calling branchless_bound for each of the count sorted values,
+         * by merging them with the range instead of searching each of them.
+         */
+        template <class T, class V, class Cmp>
+        inline void merge_bounds(const T* first, std::size_t size, const V* values, std::size_t count,
+                                 std::size_t* out, Cmp cmp) noexcept
+        {
+            if (count == 0)
+            {
+                return;
+            }
+            std::size_t pos = branchless_bound(first, size, values[0], cmp);
+            for (std::size_t k = 0; k < count; ++k)
+            {
+                while (pos < size && cmp(first[pos], values[k]))
+                {
+                    ++pos;
+                }
+                out[k] = pos;
+            }
+        }
+
+        template <class T, class V, class Cmp>
+        inline void searchsorted_impl(const T* a, std::size_t a_size, const V* v, std::size_t v_size,
+                                      std::size_t* out, Cmp cmp)
+        {
+            // When v is sorted, a linear merge costs O(a_size + v_size) against
+            // O(v_size * log(a_size)) for the binary searches.
+            std::size_t log_a_size = 1;
+            for (std::size_t n = a_size; n > 1; n >>= 1)
+            {
+                ++log_a_size;
+            }
+            bool merge = v_size > 1 && a_size <= v_size * log_a_size && std::is_sorted(v, v + v_size);
+
+            std::size_t n_blocks = parallel_block_count(v_size, searchsorted_grain_size);
+            parallel_for_blocks(n_blocks, v_size, [&](std::size_t, std::size_t begin, std::size_t end) {
+                if (merge)
+                {
+                    merge_bounds(a, a_size, v + begin, end - begin, out + begin, cmp);
+                }
+                else
+                {
+                    for (std::size_t i = begin; i < end; ++i)
+                    {
+                        out[i] = branchless_bound(a, a_size, v[i], cmp);
+                    }
+                }
+            });
+        }
+    }
+
     /**
      * @ingroup searchsorted
      * @brief Find indices where elements should be inserted to maintain order.
      *
+     * Each value is located with a branchless binary search; when ``v`` is itself
+     * sorted, the values are merged with ``a`` instead. Values are processed in
+     * parallel blocks when TBB or OpenMP is enabled.
+     *
      * @param a Input array: sorted (array_like).
      * @param v Values to insert into a (array_like).
      * @param right If ``false``, the index of the first suitable location found is given.
@@ -171,25 +466,36 @@ namespace xt
     inline auto searchsorted(E1&& a, E2&& v, bool right = true)
     {
         XTENSOR_ASSERT(std::is_sorted(a.cbegin(), a.cend()));
+        XTENSOR_ASSERT(a.dimension() == 1);
+
+        using value_type = typename std::decay_t<E2>::value_type;
 
         auto out = xt::empty<size_t>(v.shape());
 
+        auto&& ea = xt::eval(std::forward<E1>(a));
+        auto&& ev = xt::eval(std::forward<E2>(v));
+
+        // The values must be read in the storage order of out
+        std::vector<value_type> v_copy;
+        const value_type* v_ptr = ev.data();
+        if (ev.dimension() > 1 && ev.layout() != out.layout())
+        {
+            v_copy.resize(ev.size());
+            std::copy(ev.template cbegin<XTENSOR_DEFAULT_LAYOUT>(), ev.template cend<XTENSOR_DEFAULT_LAYOUT>(), v_copy.begin());
+            v_ptr = v_copy.data();
+        }
+
         if (right)
         {
-            for (size_t i = 0; i < v.size(); ++i)
-            {
-                out(i) = static_cast<std::size_t>(std::lower_bound(a.cbegin(), a.cend(), v(i)) - a.cbegin());
-            }
+            detail::searchsorted_impl(ea.data(), ea.size(), v_ptr, ev.size(), out.data(),
+                                      [](const auto& e, const auto& x) { return e < x; });
         }
         else
         {
-            for (size_t i = 0; i < v.size(); ++i)
-            {
-                out(i) = static_cast<std::size_t>(std::upper_bound(a.cbegin(), a.cend(), v(i)) - a.cbegin());
-            }
+            detail::searchsorted_impl(ea.data(), ea.size(), v_ptr, ev.size(), out.data(),
+                                      [](const auto& e, const auto& x) { return !(x < e); });
         }
 
-
         return out;
     }
 
@@ -11,7 +11,13 @@
 #define XTENSOR_SORT_HPP
 
 #include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "xarray.hpp"
 #include "xeval.hpp"
@@ -902,55 +908,482 @@ namespace xt
         return detail::arg_func_impl<L>(ed, ax, std::greater<value_type>());
     }
 
+    /**
+     * Algorithm used by ``unique`` and the related set functions.
+     *
+     * ``sort`` sorts a flattened copy of the input and returns the unique
+     * values in ascending order. ``hash`` inserts the elements into an
+     * open-addressing hash table in a single pass and returns the unique
+     * values in order of first occurrence; it requires an arithmetic
+     * value type and is much faster for large, high-cardinality inputs.
+     */
+    enum class unique_method
+    {
+        sort,
+        hash
+    };
+
+    /**
+     * Result of ``unique_all``: the unique values, the index of their
+     * first occurrence in the flattened input, for each element of the
+     * flattened input the index of its value in ``values``, and the
+     * number of occurrences of each unique value.
+     */
+    template <class T>
+    struct unique_all_result
+    {
+        xtensor<T, 1> values;
+        xtensor<std::size_t, 1> indices;
+        xtensor<std::size_t, 1> inverse_indices;
+        xtensor<std::size_t, 1> counts;
+    };
+
+    /**
+     * Result of ``unique_counts``.
+     */
+    template <class T>
+    struct unique_counts_result
+    {
+        xtensor<T, 1> values;
+        xtensor<std::size_t, 1> counts;
+    };
+
+    /**
+     * Result of ``unique_inverse``.
+     */
+    template <class T>
+    struct unique_inverse_result
+    {
+        xtensor<T, 1> values;
+        xtensor<std::size_t, 1> inverse_indices;
+    };
+
+    namespace detail
+    {
+        template <class T>
+        inline std::enable_if_t<std::is_integral<T>::value, std::uint64_t>
+        unique_hash_key(const T& value) noexcept
+        {
+            return static_cast<std::uint64_t>(value);
+        }
+
+        template <class T>
+        inline std::enable_if_t<std::is_floating_point<T>::value, std::uint64_t>
+        unique_hash_key(const T& value) noexcept
+        {
+            // +0 and -0 compare equal, they must end up in the same bucket
+            return static_cast<std::uint64_t>(std::hash<T>()(value == T(0) ? T(0) : value));
+        }
+
+        /**
+         * Open-addressing hash table with linear probing, mapping each
+         * distinct value to the rank of its first insertion. Values are
+         * additionally kept in insertion order, so that they can be
+         * returned in order of first occurrence.
+         */
+        template <class T>
+        class unique_hash_table
+        {
+        public:
+
+            using value_type = T;
+            using size_type = std::size_t;
+
+            static constexpr size_type npos = std::numeric_limits<size_type>::max();
+
+            explicit unique_hash_table(size_type size_hint = 0)
+            {
+                size_type capacity = 16;
+                while (capacity < 2 * size_hint)
+                {
+                    capacity <<= 1;
+                }
+                m_values.reserve(size_hint);
+                rehash(capacity);
+            }
+
+            // Returns the rank of value and whether it has been inserted
+            std::pair<size_type, bool> insert(const value_type& value)
+            {
+                size_type index = bucket_index(value);
+                while (m_buckets[index].id != npos)
+                {
+                    if (m_buckets[index].key == value)
+                    {
+                        return std::make_pair(m_buckets[index].id, false);
+                    }
+                    index = (index + 1) & m_mask;
+                }
+                size_type id = m_values.size();
+                m_buckets[index].key = value;
+                m_buckets[index].id = id;
+                m_values.push_back(value);
+                // Keep the load factor below 1/2 so that probe sequences remain short
+                if (2 * m_values.size() > m_buckets.size())
+                {
+                    rehash(2 * m_buckets.size());
+                }
+                return std::make_pair(id, true);
+            }
+
+            // Returns the rank of value, or npos if value has not been inserted
+            size_type find(const value_type& value) const noexcept
+            {
+                size_type index = bucket_index(value);
+                while (m_buckets[index].id != npos)
+                {
+                    if (m_buckets[index].key == value)
+                    {
+                        return m_buckets[index].id;
+                    }
+                    index = (index + 1) & m_mask;
+                }
+                return npos;
+            }
+
+            size_type size() const noexcept
+            {
+                return m_values.size();
+            }
+
+            const std::vector<value_type>& values() const noexcept
+            {
+                return m_values;
+            }
+
+        private:
+
+            struct bucket_type
+            {
+                value_type key;
+                size_type id;
+            };
+
+            size_type bucket_index(const value_type& value) const noexcept
+            {
+                // Fibonacci hashing: the high bits of the product are well mixed
+                // even for the identity hash used for integers.
+                return static_cast<size_type>((unique_hash_key(value) * std::uint64_t(0x9E3779B97F4A7C15ull)) >> m_shift);
+            }
+
+            void rehash(size_type capacity)
+            {
+                m_buckets.assign(capacity, bucket_type{value_type(), npos});
+                m_mask = capacity - 1;
+                m_shift = 64;
+                for (size_type c = capacity; c > 1; c >>= 1)
+                {
+                    --m_shift;
+                }
+                for (size_type id = 0; id < m_values.size(); ++id)
+                {
+                    size_type index = bucket_index(m_values[id]);
+                    while (m_buckets[index].id != npos)
+                    {
+                        index = (index + 1) & m_mask;
+                    }
+                    m_buckets[index].key = m_values[id];
+                    m_buckets[index].id = id;
+                }
+            }
+
+            std::vector<bucket_type> m_buckets;
+            std::vector<value_type> m_values;
+            size_type m_mask;
+            std::size_t m_shift;
+        };
+
+        template <class T>
+        constexpr typename unique_hash_table<T>::size_type unique_hash_table<T>::npos;
+
+        template <class T, class C>
+        inline xtensor<T, 1> make_unique_tensor(const C& c)
+        {
+            auto result = xtensor<T, 1>::from_shape({c.size()});
+            std::copy(c.begin(), c.end(), result.begin());
+            return result;
+        }
+
+        template <class E>
+        inline auto unique_impl(const E& de, std::false_type /*use_hash*/)
+        {
+            auto sorted = sort(de, xnone());
+            auto end = std::unique(sorted.begin(), sorted.end());
+            std::size_t sz = static_cast<std::size_t>(std::distance(sorted.begin(), end));
+            // TODO check if we can shrink the vector without reallocation
+            using value_type = typename E::value_type;
+            auto result = xtensor<value_type, 1>::from_shape({sz});
+            std::copy(sorted.begin(), end, result.begin());
+            return result;
+        }
+
+        template <class E>
+        inline auto unique_impl(const E& de, std::true_type /*use_hash*/)
+        {
+            using value_type = typename E::value_type;
+            unique_hash_table<value_type> table;
+            for (auto it = de.cbegin(); it != de.cend(); ++it)
+            {
+                table.insert(*it);
+            }
+            return make_unique_tensor<value_type>(table.values());
+        }
+
+        template <class E>
+        inline auto unique_impl(const E& de, unique_method method)
+        {
+            using value_type = typename E::value_type;
+            using use_hash = std::is_arithmetic<value_type>;
+            if (method == unique_method::hash)
+            {
+                if (!use_hash::value)
+                {
+                    XTENSOR_THROW(std::runtime_error, "unique_method::hash requires an arithmetic value type.");
+                }
+                return unique_impl(de, use_hash());
+            }
+            return unique_impl(de, std::false_type());
+        }
+
+        // Values, first indices and counts are always computed since their size
+        // is the number of unique values; the inverse indices are as large as
+        // the input and are only filled on demand.
+        template <class E>
+        inline auto unique_all_impl(const E& de, bool with_inverse, std::false_type /*use_hash*/)
+        {
+            using value_type = typename E::value_type;
+            using index_tensor = xtensor<std::size_t, 1>;
+
+            auto flat = xtensor<value_type, 1>::from_shape({de.size()});
+            std::copy(de.cbegin(), de.cend(), flat.begin());
+
+            // A stable sort of the indices keeps the first occurrence at the head of each run
+            index_tensor order = index_tensor::from_shape({flat.size()});
+            std::iota(order.begin(), order.end(), std::size_t(0));
+            std::stable_sort(order.begin(), order.end(), [&flat](std::size_t x, std::size_t y) {
+                return flat(x) < flat(y);
+            });
+
+            unique_all_result<value_type> res;
+            if (with_inverse)
+            {
+                res.inverse_indices = index_tensor::from_shape({flat.size()});
+            }
+            std::vector<value_type> values;
+            std::vector<std::size_t> first, counts;
+            for (std::size_t k = 0; k < order.size(); ++k)
+            {
+                std::size_t idx = order(k);
+                if (k == 0 || !(flat(idx) == values.back()))
+                {
+                    values.push_back(flat(idx));
+                    first.push_back(idx);
+                    counts.push_back(0);
+                }
+                ++counts.back();
+                if (with_inverse)
+                {
+                    res.inverse_indices(idx) = values.size() - 1;
+                }
+            }
+            res.values = make_unique_tensor<value_type>(values);
+            res.indices = make_unique_tensor<std::size_t>(first);
+            res.counts = make_unique_tensor<std::size_t>(counts);
+            return res;
+        }
+
+        template <class E>
+        inline auto unique_all_impl(const E& de, bool with_inverse, std::true_type /*use_hash*/)
+        {
+            using value_type = typename E::value_type;
+            using index_tensor = xtensor<std::size_t, 1>;
+
+            unique_all_result<value_type> res;
+            if (with_inverse)
+            {
+                res.inverse_indices = index_tensor::from_shape({de.size()});
+            }
+            unique_hash_table<value_type> table;
+            std::vector<std::size_t> first, counts;
+            std::size_t i = 0;
+            for (auto it = de.cbegin(); it != de.cend(); ++it, ++i)
+            {
+                auto inserted = table.insert(*it);
+                if (inserted.second)
+                {
+                    first.push_back(i);
+                    counts.push_back(0);
+                }
+                ++counts[inserted.first];
+                if (with_inverse)
+                {
+                    res.inverse_indices(i) = inserted.first;
+                }
+            }
+            res.values = make_unique_tensor<value_type>(table.values());
+            res.indices = make_unique_tensor<std::size_t>(first);
+            res.counts = make_unique_tensor<std::size_t>(counts);
+            return res;
+        }
+
+        template <class E>
+        inline auto unique_all_impl(const E& de, bool with_inverse, unique_method method)
+        {
+            using value_type = typename E::value_type;
+            using use_hash = std::is_arithmetic<value_type>;
+            if (method == unique_method::hash)
+            {
+                if (!use_hash::value)
+                {
+                    XTENSOR_THROW(std::runtime_error, "unique_method::hash requires an arithmetic value type.");
+                }
+                return unique_all_impl(de, with_inverse, use_hash());
+            }
+            return unique_all_impl(de, with_inverse, std::false_type());
+        }
+    }
+
     /**
      * Find unique elements of a xexpression. This returns a flattened xtensor with
-     * sorted, unique elements from the original expression.
+     * the unique elements from the original expression, sorted when using
+     * ``unique_method::sort`` and in order of first occurrence when using
+     * ``unique_method::hash``.
      *
      * @param e input xexpression (will be flattened)
+     * @param method the algorithm to use [default: unique_method::sort]
      */
     template <class E>
-    inline auto unique(const xexpression<E>& e)
+    inline auto unique(const xexpression<E>& e, unique_method method = unique_method::sort)
+    {
+        return detail::unique_impl(e.derived_cast(), method);
+    }
+
+    /**
+     * Find unique elements of a xexpression, together with the index of their
+     * first occurrence, the inverse indices and the number of occurrences,
+     * in a single pass. Indices refer to the flattened expression.
+     *
+     * @param e input xexpression (will be flattened)
+     * @param method the algorithm to use [default: unique_method::sort]
+     * @return a unique_all_result
+     */
+    template <class E>
+    inline auto unique_all(const xexpression<E>& e, unique_method method = unique_method::sort)
+    {
+        return detail::unique_all_impl(e.derived_cast(), true, method);
+    }
+
+    /**
+     * Find unique elements of a xexpression and the number of times
+     * each of them occurs.
+     *
+     * @param e input xexpression (will be flattened)
+     * @param method the algorithm to use [default: unique_method::sort]
+     * @return a unique_counts_result
+     */
+    template <class E>
+    inline auto unique_counts(const xexpression<E>& e, unique_method method = unique_method::sort)
     {
-        auto sorted = sort(e, xnone());
-        auto end = std::unique(sorted.begin(), sorted.end());
-        std::size_t sz = static_cast<std::size_t>(std::distance(sorted.begin(), end));
-        // TODO check if we can shrink the vector without reallocation
         using value_type = typename E::value_type;
-        auto result = xtensor<value_type, 1>::from_shape({sz});
-        std::copy(sorted.begin(), end, result.begin());
-        return result;
+        auto res = detail::unique_all_impl(e.derived_cast(), false, method);
+        return unique_counts_result<value_type>{std::move(res.values), std::move(res.counts)};
     }
 
     /**
-     * Find the set difference of two xexpressions. This returns a flattened xtensor with
-     * the sorted, unique values in ar1 that are not in ar2.
+     * Find unique elements of a xexpression and, for each element of the
+     * flattened expression, the index of its value in the unique values.
      *
-     * @param ar1 input xexpression (will be flattened)
-     * @param ar2 input xexpression
+     * @param e input xexpression (will be flattened)
+     * @param method the algorithm to use [default: unique_method::sort]
+     * @return a unique_inverse_result
      */
-    template <class E1, class E2>
-    inline auto setdiff1d(const xexpression<E1>& ar1, const xexpression<E2>& ar2)
+    template <class E>
+    inline auto unique_inverse(const xexpression<E>& e, unique_method method = unique_method::sort)
+    {
+        using value_type = typename E::value_type;
+        auto res = detail::unique_all_impl(e.derived_cast(), true, method);
+        return unique_inverse_result<value_type>{std::move(res.values), std::move(res.inverse_indices)};
+    }
+
+    namespace detail
     {
-        using value_type = typename E1::value_type;
+        template <class E1, class E2>
+        inline auto setdiff1d_impl(const E1& de1, const E2& de2, std::false_type /*use_hash*/)
+        {
+            using value_type = typename E1::value_type;
+
+            auto unique1 = unique(de1);
+            auto unique2 = unique(de2);
+
+            auto tmp = xtensor<value_type, 1>::from_shape({unique1.size()});
 
-        auto unique1 = unique(ar1);
-        auto unique2 = unique(ar2);
+            auto end = std::set_difference(
+                unique1.begin(), unique1.end(),
+                unique2.begin(), unique2.end(),
+                tmp.begin()
+            );
 
-        auto tmp = xtensor<value_type, 1>::from_shape({unique1.size()});
+            std::size_t sz = static_cast<std::size_t>(std::distance(tmp.begin(), end));
 
-        auto end = std::set_difference(
-            unique1.begin(), unique1.end(),
-            unique2.begin(), unique2.end(),
-            tmp.begin()
-        );
+            auto result = xtensor<value_type, 1>::from_shape({sz});
 
-        std::size_t sz = static_cast<std::size_t>(std::distance(tmp.begin(), end));
+            std::copy(tmp.begin(), end, result.begin());
 
-        auto result = xtensor<value_type, 1>::from_shape({sz});
+            return result;
+        }
+
+        template <class E1, class E2>
+        inline auto setdiff1d_impl(const E1& de1, const E2& de2, std::true_type /*use_hash*/)
+        {
+            using value_type = typename E1::value_type;
+            using common_type = std::common_type_t<value_type, typename E2::value_type>;
+            using excluded_table = unique_hash_table<common_type>;
+
+            excluded_table excluded(de2.size());
+            for (auto it = de2.cbegin(); it != de2.cend(); ++it)
+            {
+                excluded.insert(static_cast<common_type>(*it));
+            }
 
-        std::copy(tmp.begin(), end, result.begin());
+            unique_hash_table<value_type> kept;
+            for (auto it = de1.cbegin(); it != de1.cend(); ++it)
+            {
+                if (excluded.find(static_cast<common_type>(*it)) == excluded_table::npos)
+                {
+                    kept.insert(*it);
+                }
+            }
+            return make_unique_tensor<value_type>(kept.values());
+        }
+    }
 
-        return result;
+    /**
+     * Find the set difference of two xexpressions. This returns a flattened xtensor with
+     * the unique values in ar1 that are not in ar2, sorted when using
+     * ``unique_method::sort`` and in order of first occurrence in ar1 when using
+     * ``unique_method::hash``.
+     *
+     * @param ar1 input xexpression (will be flattened)
+     * @param ar2 input xexpression
+     * @param method the algorithm to use [default: unique_method::sort]
+     */
+    template <class E1, class E2>
+    inline auto setdiff1d(const xexpression<E1>& ar1, const xexpression<E2>& ar2,
+                          unique_method method = unique_method::sort)
+    {
+        using use_hash = xtl::conjunction<std::is_arithmetic<typename E1::value_type>,
+                                          std::is_arithmetic<typename E2::value_type>>;
+        const auto& de1 = ar1.derived_cast();
+        const auto& de2 = ar2.derived_cast();
+        if (method == unique_method::hash)
+        {
+            if (!use_hash::value)
+            {
+                XTENSOR_THROW(std::runtime_error, "unique_method::hash requires arithmetic value types.");
+            }
+            return detail::setdiff1d_impl(de1, de2, use_hash());
+        }
+        return detail::setdiff1d_impl(de1, de2, std::false_type());
     }
 }
 
@@ -12,11 +12,13 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <exception>
 #include <functional>
 #include <initializer_list>
 #include <iterator>
 #include <memory>
 #include <type_traits>
+#include <vector>
 
 #include "xexception.hpp"
 #include "xtensor_config.hpp"
@@ -63,6 +65,7 @@ namespace xt
         explicit uvector(const allocator_type& alloc) noexcept;
         explicit uvector(size_type count, const allocator_type& alloc = allocator_type());
         uvector(size_type count, const_reference value, const allocator_type& alloc = allocator_type());
+        uvector(size_type count, uninitialized_t, const allocator_type& alloc = allocator_type());
 
         template <class InputIt, class = detail::require_input_iter<InputIt>>
         uvector(InputIt first, InputIt last, const allocator_type& alloc = allocator_type());
@@ -84,6 +87,7 @@ namespace xt
         bool empty() const noexcept;
         size_type size() const noexcept;
         void resize(size_type size);
+        void resize(size_type size, uninitialized_t);
         size_type max_size() const noexcept;
         void reserve(size_type new_cap);
         size_type capacity() const noexcept;
@@ -131,6 +135,7 @@ namespace xt
         void init_data(I first, I last);
 
         void resize_impl(size_type new_size);
+        void resize_impl(size_type new_size, uninitialized_t);
 
         allocator_type m_allocator;
 
@@ -185,6 +190,56 @@ namespace xt
             return res;
         }
 
+        template <class A>
+        inline typename std::allocator_traits<A>::pointer
+        default_init_allocate(A& alloc, typename std::allocator_traits<A>::size_type size)
+        {
+            using traits = std::allocator_traits<A>;
+            using pointer = typename traits::pointer;
+            using value_type = typename traits::value_type;
+            pointer res = traits::allocate(alloc, size);
+            if (!xtrivially_default_constructible<value_type>::value)
+            {
+                // Elements are value-initialized in parallel, as by parallel_fill
+                std::size_t n_blocks = std::is_nothrow_default_constructible<value_type>::value ?
+                    parallel_block_count(size, fill_grain_size) : std::size_t(1);
+                std::vector<std::size_t> first(n_blocks, 0), constructed(n_blocks, 0);
+                std::vector<std::exception_ptr> errors(n_blocks);
+                parallel_for_blocks(n_blocks, size, [&](std::size_t b, std::size_t begin, std::size_t end)
+                {
+                    first[b] = begin;
+                    try
+                    {
+                        for (pointer p = res + begin; p != res + end; ++p)
+                        {
+                            traits::construct(alloc, p);
+                            ++constructed[b];
+                        }
+                    }
+                    catch (...)
+                    {
+                        errors[b] = std::current_exception();
+                    }
+                });
+
+                auto error = std::find_if(errors.cbegin(), errors.cend(), [](const std::exception_ptr& e) { return bool(e); });
+                if (error != errors.cend())
+                {
+                    // destroys the elements constructed by every block
+                    for (std::size_t b = 0; b < n_blocks; ++b)
+                    {
+                        for (pointer p = res + first[b]; p != res + first[b] + constructed[b]; ++p)
+                        {
+                            traits::destroy(alloc, p);
+                        }
+                    }
+                    traits::deallocate(alloc, res, size);
+                    std::rethrow_exception(*error);
+                }
+            }
+            return res;
+        }
+
         template <class A>
         inline void safe_destroy_deallocate(A& alloc, typename std::allocator_traits<A>::pointer ptr,
                                             typename std::allocator_traits<A>::size_type size)
@@ -232,6 +287,19 @@ namespace xt
         }
     }
 
+    template <class T, class A>
+    inline void uvector<T, A>::resize_impl(size_type new_size, uninitialized_t)
+    {
+        size_type old_size = size();
+        pointer old_begin = p_begin;
+        if (new_size != old_size)
+        {
+            p_begin = detail::default_init_allocate(m_allocator, new_size);
+            p_end = p_begin + new_size;
+            detail::safe_destroy_deallocate(m_allocator, old_begin, old_size);
+        }
+    }
+
     template <class T, class A>
     inline uvector<T, A>::uvector() noexcept
         : uvector(allocator_type())
@@ -263,7 +331,31 @@ namespace xt
         {
             p_begin = m_allocator.allocate(count);
             p_end = p_begin + count;
-            std::uninitialized_fill(p_begin, p_end, value);
+            if (xtrivially_default_constructible<value_type>::value)
+            {
+                detail::parallel_fill(p_begin, p_end, value);
+            }
+            else
+            {
+                std::uninitialized_fill(p_begin, p_end, value);
+            }
+        }
+    }
+
+    /**
+     * Allocates storage for \c count elements, which are left uninitialized
+     * for trivially default constructible types. Elements of other types are
+     * value-initialized, in parallel when TBB or OpenMP is enabled and the
+     * default constructor does not throw.
+     */
+    template <class T, class A>
+    inline uvector<T, A>::uvector(size_type count, uninitialized_t, const allocator_type& alloc)
+        : m_allocator(alloc), p_begin(nullptr), p_end(nullptr)
+    {
+        if (count != 0)
+        {
+            p_begin = detail::default_init_allocate(m_allocator, count);
+            p_end = p_begin + count;
         }
     }
 
@@ -375,6 +467,16 @@ namespace xt
         resize_impl(size);
     }
 
+    /**
+     * Resizes the container without preserving its elements. New elements
+     * are left uninitialized, see uvector(size_type, uninitialized_t, const allocator_type&).
+     */
+    template <class T, class A>
+    inline void uvector<T, A>::resize(size_type size, uninitialized_t)
+    {
+        resize_impl(size, uninitialized);
+    }
+
     template <class T, class A>
     inline auto uvector<T, A>::max_size() const noexcept -> size_type
     {
@@ -111,6 +111,7 @@ namespace xt
         xtensor_container(nested_initializer_list_t<value_type, N> t);
         explicit xtensor_container(const shape_type& shape, layout_type l = L);
         explicit xtensor_container(const shape_type& shape, const_reference value, layout_type l = L);
+        explicit xtensor_container(uninitialized_t, const shape_type& shape, layout_type l = L);
         explicit xtensor_container(const shape_type& shape, const strides_type& strides);
         explicit xtensor_container(const shape_type& shape, const strides_type& strides, const_reference value);
         explicit xtensor_container(storage_type&& storage, inner_shape_type&& shape, inner_strides_type&& strides);
@@ -449,8 +450,23 @@ namespace xt
     inline xtensor_container<EC, N, L, Tag>::xtensor_container(const shape_type& shape, const_reference value, layout_type l)
         : base_type()
     {
-        base_type::resize(shape, l);
-        std::fill(m_storage.begin(), m_storage.end(), value);
+        base_type::resize(shape, l, uninitialized);
+        detail::parallel_fill(m_storage.begin(), m_storage.end(), value);
+    }
+
+    /**
+     * Allocates a xtensor_container with the specified shape and layout_type, whose
+     * elements are left uninitialized for trivially default constructible types
+     * when the data container supports it. Elements of other types are
+     * value-initialized, in parallel when TBB or OpenMP is enabled.
+     * @param shape the shape of the xtensor_container
+     * @param l the layout_type of the xtensor_container
+     */
+    template <class EC, std::size_t N, layout_type L, class Tag>
+    inline xtensor_container<EC, N, L, Tag>::xtensor_container(uninitialized_t, const shape_type& shape, layout_type l)
+        : base_type()
+    {
+        base_type::resize(shape, l, uninitialized);
     }
 
     /**
@@ -524,7 +540,7 @@ namespace xt
     {
         XTENSOR_ASSERT_MSG(s.size() == N, "Cannot change dimension of xtensor.");
         shape_type shape = xtl::forward_sequence<shape_type, S>(s);
-        return self_type(shape);
+        return self_type(uninitialized, shape);
     }
     //@}
 
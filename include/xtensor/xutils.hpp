@@ -12,13 +12,19 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
 #include <complex>
 #include <cstddef>
 #include <initializer_list>
+#include <iterator>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <tuple>
+#include <typeinfo>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -30,6 +36,10 @@
 
 #include "xtensor_config.hpp"
 
+#if defined(XTENSOR_USE_TBB)
+#include <tbb/tbb.h>
+#endif
+
 #if (_MSC_VER >= 1910)
     #define NOEXCEPT(T)
 #else
@@ -718,7 +728,491 @@ namespace xt
         enum policy
         {
             print,
-            assert
+            assert,
+            stats
+        };
+
+        // Number of buckets of the size histogram, bucket i counts the
+        // allocations of [2^(i-1), 2^i) bytes, bucket 0 those of 0 byte
+        constexpr std::size_t histogram_size = 64;
+        // Maximal number of value types and tags tracked separately, the
+        // ones registered beyond share an additional overflow slot
+        constexpr std::size_t max_tracked_types = 32;
+        constexpr std::size_t max_tracked_tags = 32;
+
+        /**
+         * Snapshot of the allocations recorded by the tracking allocators
+         * using the stats policy.
+         */
+        struct statistics
+        {
+            std::size_t allocations = 0;
+            std::size_t deallocations = 0;
+            std::size_t allocated_bytes = 0;
+            std::size_t deallocated_bytes = 0;
+            /// approximate highest number of live bytes, only for
+            /// total_statistics: the sum of the peaks of the threads, each
+            /// thread accounting for the bytes it allocates and deallocates.
+            /// It is exact when a single thread allocates and deallocates.
+            std::size_t peak_live_bytes = 0;
+            /// histogram of the allocation sizes, only for total_statistics
+            std::array<std::size_t, histogram_size> size_histogram = {};
+
+            /// Buffers allocated before tracking was enabled or before the
+            /// statistics were reset may be deallocated while tracking, the
+            /// result is clamped at zero.
+            std::size_t live_bytes() const noexcept
+            {
+                return allocated_bytes > deallocated_bytes ? allocated_bytes - deallocated_bytes : std::size_t(0);
+            }
+        };
+
+        namespace detail
+        {
+            // Counters are only written by their owning thread, so that
+            // relaxed loads and stores are enough; they are atomic so that
+            // other threads can read them while computing a snapshot.
+            struct counters
+            {
+                std::atomic<std::size_t> allocations;
+                std::atomic<std::size_t> deallocations;
+                std::atomic<std::size_t> allocated_bytes;
+                std::atomic<std::size_t> deallocated_bytes;
+
+                counters() noexcept
+                {
+                    reset();
+                }
+
+                void reset() noexcept
+                {
+                    allocations.store(0, std::memory_order_relaxed);
+                    deallocations.store(0, std::memory_order_relaxed);
+                    allocated_bytes.store(0, std::memory_order_relaxed);
+                    deallocated_bytes.store(0, std::memory_order_relaxed);
+                }
+
+                void add_to(statistics& s) const noexcept
+                {
+                    s.allocations += allocations.load(std::memory_order_relaxed);
+                    s.deallocations += deallocations.load(std::memory_order_relaxed);
+                    s.allocated_bytes += allocated_bytes.load(std::memory_order_relaxed);
+                    s.deallocated_bytes += deallocated_bytes.load(std::memory_order_relaxed);
+                }
+            };
+
+            inline void increment(std::atomic<std::size_t>& c, std::size_t n) noexcept
+            {
+                c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            }
+
+            // Slots of the types and tags registered beyond the maximal numbers
+            constexpr std::size_t overflow_type = max_tracked_types;
+            constexpr std::size_t overflow_tag = max_tracked_tags;
+            // Index of the current tag when no tag is active
+            constexpr std::size_t no_tag = max_tracked_tags + 1;
+
+            struct thread_counters
+            {
+                counters total;
+                std::array<std::atomic<std::size_t>, histogram_size> histogram;
+                std::array<counters, max_tracked_types + 1> types;
+                std::array<counters, max_tracked_tags + 1> tags;
+                // Bytes allocated minus bytes deallocated by the thread, which
+                // is negative when it deallocates buffers of other threads
+                std::atomic<std::ptrdiff_t> live_bytes;
+                std::atomic<std::ptrdiff_t> peak_live_bytes;
+
+                thread_counters() noexcept
+                {
+                    reset();
+                }
+
+                void add_live_bytes(std::ptrdiff_t n) noexcept
+                {
+                    std::ptrdiff_t live = live_bytes.load(std::memory_order_relaxed) + n;
+                    live_bytes.store(live, std::memory_order_relaxed);
+                    if (live > peak_live_bytes.load(std::memory_order_relaxed))
+                    {
+                        peak_live_bytes.store(live, std::memory_order_relaxed);
+                    }
+                }
+
+                void reset() noexcept
+                {
+                    live_bytes.store(0, std::memory_order_relaxed);
+                    peak_live_bytes.store(0, std::memory_order_relaxed);
+                    total.reset();
+                    for (auto& h : histogram)
+                    {
+                        h.store(0, std::memory_order_relaxed);
+                    }
+                    for (auto& c : types)
+                    {
+                        c.reset();
+                    }
+                    for (auto& c : tags)
+                    {
+                        c.reset();
+                    }
+                }
+
+                // Only called under the registry lock, on counters of
+                // exited threads
+                void merge(const thread_counters& rhs) noexcept
+                {
+                    auto merge_counters = [](counters& lhs, const counters& r) {
+                        increment(lhs.allocations, r.allocations.load(std::memory_order_relaxed));
+                        increment(lhs.deallocations, r.deallocations.load(std::memory_order_relaxed));
+                        increment(lhs.allocated_bytes, r.allocated_bytes.load(std::memory_order_relaxed));
+                        increment(lhs.deallocated_bytes, r.deallocated_bytes.load(std::memory_order_relaxed));
+                    };
+                    merge_counters(total, rhs.total);
+                    for (std::size_t i = 0; i < histogram_size; ++i)
+                    {
+                        increment(histogram[i], rhs.histogram[i].load(std::memory_order_relaxed));
+                    }
+                    for (std::size_t i = 0; i < types.size(); ++i)
+                    {
+                        merge_counters(types[i], rhs.types[i]);
+                    }
+                    for (std::size_t i = 0; i < tags.size(); ++i)
+                    {
+                        merge_counters(tags[i], rhs.tags[i]);
+                    }
+                    // the peak of an exited thread may have been reached
+                    // on top of the bytes left by the previous ones
+                    std::ptrdiff_t live = live_bytes.load(std::memory_order_relaxed);
+                    std::ptrdiff_t peak = (std::max)(live, std::ptrdiff_t(0)) + rhs.peak_live_bytes.load(std::memory_order_relaxed);
+                    live_bytes.store(live + rhs.live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                    if (peak > peak_live_bytes.load(std::memory_order_relaxed))
+                    {
+                        peak_live_bytes.store(peak, std::memory_order_relaxed);
+                    }
+                }
+            };
+
+            class registry
+            {
+            public:
+
+                void add_thread(thread_counters* c)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_threads.push_back(c);
+                }
+
+                void remove_thread(thread_counters* c)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_retired.merge(*c);
+                    m_threads.erase(std::remove(m_threads.begin(), m_threads.end(), c), m_threads.end());
+                }
+
+                std::size_t type_index(const char* name)
+                {
+                    return index_of(m_type_names, name, overflow_type);
+                }
+
+                std::size_t tag_index(const char* name)
+                {
+                    return index_of(m_tag_names, name, overflow_tag);
+                }
+
+                // Returns no_tag if the tag was never registered
+                std::size_t find_tag(const char* name)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    auto it = std::find(m_tag_names.cbegin(), m_tag_names.cend(), name);
+                    if (it == m_tag_names.cend())
+                    {
+                        return no_tag;
+                    }
+                    std::size_t res = static_cast<std::size_t>(std::distance(m_tag_names.cbegin(), it));
+                    return (std::min)(res, overflow_tag);
+                }
+
+                template <class F>
+                statistics collect(F&& get)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    statistics res;
+                    get(m_retired).add_to(res);
+                    for (const thread_counters* c : m_threads)
+                    {
+                        get(*c).add_to(res);
+                    }
+                    return res;
+                }
+
+                statistics collect_total()
+                {
+                    statistics res = collect([](const thread_counters& c) -> const counters& { return c.total; });
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    for (std::size_t i = 0; i < histogram_size; ++i)
+                    {
+                        res.size_histogram[i] = m_retired.histogram[i].load(std::memory_order_relaxed);
+                        for (const thread_counters* c : m_threads)
+                        {
+                            res.size_histogram[i] += c->histogram[i].load(std::memory_order_relaxed);
+                        }
+                    }
+                    std::ptrdiff_t peak = m_retired.peak_live_bytes.load(std::memory_order_relaxed);
+                    for (const thread_counters* c : m_threads)
+                    {
+                        peak += c->peak_live_bytes.load(std::memory_order_relaxed);
+                    }
+                    res.peak_live_bytes = (std::max)(static_cast<std::size_t>((std::max)(peak, std::ptrdiff_t(0))),
+                                                     res.live_bytes());
+                    return res;
+                }
+
+                void reset()
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_retired.reset();
+                    for (thread_counters* c : m_threads)
+                    {
+                        c->reset();
+                    }
+                }
+
+            private:
+
+                std::size_t index_of(std::vector<std::string>& names, const char* name, std::size_t overflow)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    auto it = std::find(names.cbegin(), names.cend(), name);
+                    std::size_t res = static_cast<std::size_t>(std::distance(names.cbegin(), it));
+                    if (it == names.cend())
+                    {
+                        names.push_back(name);
+                    }
+                    return (std::min)(res, overflow);
+                }
+
+                std::mutex m_mutex;
+                std::vector<thread_counters*> m_threads;
+                thread_counters m_retired;
+                std::vector<std::string> m_type_names;
+                std::vector<std::string> m_tag_names;
+            };
+
+            inline registry& get_registry()
+            {
+                static registry r;
+                return r;
+            }
+
+            struct thread_counters_holder
+            {
+                thread_counters_holder()
+                {
+                    get_registry().add_thread(&m_counters);
+                }
+
+                ~thread_counters_holder()
+                {
+                    get_registry().remove_thread(&m_counters);
+                }
+
+                thread_counters m_counters;
+            };
+
+            inline thread_counters& this_thread_counters()
+            {
+                static thread_local thread_counters_holder holder;
+                return holder.m_counters;
+            }
+
+            inline std::size_t& current_tag()
+            {
+                static thread_local std::size_t tag = no_tag;
+                return tag;
+            }
+
+            template <class T>
+            inline std::size_t type_index()
+            {
+                static const std::size_t index = get_registry().type_index(typeid(T).name());
+                return index;
+            }
+
+            inline std::size_t histogram_bucket(std::size_t bytes) noexcept
+            {
+                std::size_t bucket = 0;
+                while (bytes != 0 && bucket < histogram_size - 1)
+                {
+                    bytes >>= 1;
+                    ++bucket;
+                }
+                return bucket;
+            }
+
+            template <class T>
+            inline void record_allocation(std::size_t n)
+            {
+                std::size_t bytes = n * sizeof(T);
+                thread_counters& c = this_thread_counters();
+                increment(c.total.allocations, 1);
+                increment(c.total.allocated_bytes, bytes);
+                increment(c.histogram[histogram_bucket(bytes)], 1);
+                counters& t = c.types[type_index<T>()];
+                increment(t.allocations, 1);
+                increment(t.allocated_bytes, bytes);
+                std::size_t tag = current_tag();
+                if (tag != no_tag)
+                {
+                    increment(c.tags[tag].allocations, 1);
+                    increment(c.tags[tag].allocated_bytes, bytes);
+                }
+                c.add_live_bytes(static_cast<std::ptrdiff_t>(bytes));
+            }
+
+            template <class T>
+            inline void record_deallocation(std::size_t n)
+            {
+                std::size_t bytes = n * sizeof(T);
+                thread_counters& c = this_thread_counters();
+                increment(c.total.deallocations, 1);
+                increment(c.total.deallocated_bytes, bytes);
+                counters& t = c.types[type_index<T>()];
+                increment(t.deallocations, 1);
+                increment(t.deallocated_bytes, bytes);
+                c.add_live_bytes(-static_cast<std::ptrdiff_t>(bytes));
+            }
+        }
+
+        /**
+         * Returns the statistics of all the allocations recorded by the
+         * tracking allocators using the stats policy, on all threads.
+         */
+        inline statistics total_statistics()
+        {
+            return detail::get_registry().collect_total();
+        }
+
+        /**
+         * Returns the statistics of the allocations of elements of type T.
+         * The types registered beyond max_tracked_types share the statistics
+         * of an overflow slot.
+         */
+        template <class T>
+        inline statistics type_statistics()
+        {
+            std::size_t index = detail::type_index<T>();
+            return detail::get_registry().collect([index](const detail::thread_counters& c) -> const detail::counters& {
+                return c.types[index];
+            });
+        }
+
+        /**
+         * @class tag
+         * @brief Handle on a tag, registered once on construction.
+         *
+         * Building a scoped_tag from a handle does not look the tag up in the
+         * registry, which makes it suitable for hot code:
+         *
+         * \code{.cpp}
+         * static const alloc_tracking::tag hot_loop("hot_loop");
+         * for (...)
+         * {
+         *     alloc_tracking::scoped_tag t(hot_loop);
+         *     ...
+         * }
+         * \endcode
+         */
+        class tag
+        {
+        public:
+
+            explicit tag(const char* name)
+                : m_index(detail::get_registry().tag_index(name))
+            {
+            }
+
+            std::size_t index() const noexcept
+            {
+                return m_index;
+            }
+
+        private:
+
+            std::size_t m_index;
+        };
+
+        /**
+         * Returns the statistics of the allocations made while the tag
+         * \c name was active. Deallocations are not recorded per tag.
+         */
+        inline statistics tag_statistics(const char* name)
+        {
+            std::size_t index = detail::get_registry().find_tag(name);
+            if (index == detail::no_tag)
+            {
+                return statistics();
+            }
+            return detail::get_registry().collect([index](const detail::thread_counters& c) -> const detail::counters& {
+                return c.tags[index];
+            });
+        }
+
+        /**
+         * Returns the statistics of the allocations made while the tag \c t
+         * was active.
+         */
+        inline statistics tag_statistics(const tag& t)
+        {
+            std::size_t index = t.index();
+            return detail::get_registry().collect([index](const detail::thread_counters& c) -> const detail::counters& {
+                return c.tags[index];
+            });
+        }
+
+        /**
+         * Resets all the statistics. Allocations made concurrently may be
+         * partially lost.
+         */
+        inline void reset_statistics()
+        {
+            detail::get_registry().reset();
+        }
+
+        /**
+         * @class scoped_tag
+         * @brief Tags the allocations made by the current thread during its lifetime.
+         *
+         * Building a scoped_tag from a name looks the tag up in the registry
+         * under a lock; in hot code, build it from a tag handle instead.
+         * Nested tags override the enclosing ones.
+         */
+        class scoped_tag
+        {
+        public:
+
+            explicit scoped_tag(const char* name)
+                : m_previous(detail::current_tag())
+            {
+                detail::current_tag() = detail::get_registry().tag_index(name);
+            }
+
+            explicit scoped_tag(const tag& t) noexcept
+                : m_previous(detail::current_tag())
+            {
+                detail::current_tag() = t.index();
+            }
+
+            ~scoped_tag()
+            {
+                detail::current_tag() = m_previous;
+            }
+
+            scoped_tag(const scoped_tag&) = delete;
+            scoped_tag& operator=(const scoped_tag&) = delete;
+
+        private:
+
+            std::size_t m_previous;
         };
     }
 
@@ -751,11 +1245,23 @@ namespace xt
                                   "xtensor allocation of " + std::to_string(n) +
                                   " elements detected");
                 }
+                else if (P == alloc_tracking::stats)
+                {
+                    alloc_tracking::detail::record_allocation<T>(n);
+                }
             }
             return base_type::allocate(n);
         }
 
-        using base_type::deallocate;
+        void deallocate(T* p, std::size_t n)
+        {
+            if (P == alloc_tracking::stats && alloc_tracking::enabled())
+            {
+                alloc_tracking::detail::record_deallocation<T>(n);
+            }
+            base_type::deallocate(p, n);
+        }
+
         using base_type::construct;
         using base_type::destroy;
 
@@ -900,6 +1406,112 @@ namespace xt
     template <class E, size_t N>
     using has_rank_t = typename has_rank<std::decay_t<E>, N>::type;
 
+    /***********************
+     * parallel_for_blocks *
+     ***********************/
+
+    namespace detail
+    {
+        /**
+         * Returns the number of blocks [0, size) should be split into so that
+         * each block holds at least grain elements and, when TBB or OpenMP is
+         * enabled, every hardware thread gets some work.
+         */
+        inline std::size_t parallel_block_count(std::size_t size, std::size_t grain)
+        {
+#if defined(XTENSOR_USE_TBB) || defined(XTENSOR_USE_OPENMP)
+            std::size_t max_blocks = (std::max)(std::size_t(1), size / (std::max)(grain, std::size_t(1)));
+            std::size_t n_threads = (std::max)(std::size_t(std::thread::hardware_concurrency()), std::size_t(1));
+            return (std::min)(max_blocks, n_threads);
+#else
+            (void) size;
+            (void) grain;
+            return std::size_t(1);
+#endif
+        }
+
+        /**
+         * Splits [0, size) into n_blocks contiguous blocks and calls f(block, begin, end)
+         * for each of them, in parallel when TBB or OpenMP is enabled. Blocks are
+         * numbered so that callers can privatize per-block state and merge it afterwards.
+         */
+        template <class F>
+        inline void parallel_for_blocks(std::size_t n_blocks, std::size_t size, F&& f)
+        {
+            auto block_begin = [n_blocks, size](std::size_t b) {
+                return static_cast<std::size_t>((static_cast<unsigned long long>(size) * b) / n_blocks);
+            };
+#if defined(XTENSOR_USE_TBB)
+            tbb::parallel_for(std::size_t(0), n_blocks, [&](std::size_t b)
+            {
+                f(b, block_begin(b), block_begin(b + 1));
+            });
+#elif defined(XTENSOR_USE_OPENMP)
+            #pragma omp parallel for
+            for (std::ptrdiff_t ib = 0; ib < static_cast<std::ptrdiff_t>(n_blocks); ++ib)
+            {
+                std::size_t b = static_cast<std::size_t>(ib);
+                f(b, block_begin(b), block_begin(b + 1));
+            }
+#else
+            for (std::size_t b = 0; b < n_blocks; ++b)
+            {
+                f(b, block_begin(b), block_begin(b + 1));
+            }
+#endif
+        }
+
+        // Minimal number of elements per block of a parallel fill
+        constexpr std::size_t fill_grain_size = std::size_t(1) << 16;
+
+        /**
+         * Assigns value to the elements of [first, last), in parallel when TBB
+         * or OpenMP is enabled. Each thread first touches the pages of the
+         * contiguous blocks it handles, which spreads a fresh buffer over the
+         * NUMA nodes of the threads. The assignment loops partition the
+         * elements differently, so a page is not guaranteed to be touched by
+         * the thread that later computes on it.
+         */
+        template <class It, class T>
+        inline void parallel_fill(It first, It last, const T& value)
+        {
+            using value_type = typename std::iterator_traits<It>::value_type;
+            using reference = typename std::iterator_traits<It>::reference;
+            // Elements accessed through proxies, such as the bits of
+            // std::vector<bool>, may share memory with their neighbours
+            constexpr bool distinct_elements = std::is_pointer<It>::value
+                                            || std::is_same<reference, value_type&>::value;
+            std::size_t size = static_cast<std::size_t>(std::distance(first, last));
+            std::size_t n_blocks = parallel_block_count(size, fill_grain_size);
+            // An exception thrown in a parallel block could not be propagated
+            if (!distinct_elements || n_blocks <= std::size_t(1)
+                || !std::is_nothrow_copy_assignable<value_type>::value)
+            {
+                std::fill(first, last, value);
+                return;
+            }
+            parallel_for_blocks(n_blocks, size, [first, &value](std::size_t, std::size_t begin, std::size_t end)
+            {
+                std::fill(first + static_cast<std::ptrdiff_t>(begin), first + static_cast<std::ptrdiff_t>(end), value);
+            });
+        }
+    }
+
+    /*****************
+     * uninitialized *
+     *****************/
+
+    /**
+     * Tag type selecting the constructors and resize methods of containers
+     * that leave the elements uninitialized for trivially default
+     * constructible types, when the data container supports it.
+     */
+    struct uninitialized_t
+    {
+        explicit uninitialized_t() = default;
+    };
+
+    constexpr uninitialized_t uninitialized{};
 }
 
 #endif
@@ -13,6 +13,8 @@
 #include "xtensor/xmanipulation.hpp"
 #include "xtensor/xio.hpp"
 #include "test_common.hpp"
+#include <algorithm>
+#include <complex>
 #include <type_traits>
 
 namespace xt
@@ -77,6 +79,22 @@ namespace xt
         }
     }
 
+    TEST(xarray, uninitialized_constructor)
+    {
+        row_major_result<> rm;
+        xarray_dynamic ra(uninitialized, rm.m_shape, layout_type::row_major);
+        compare_shape(ra, rm);
+
+        xarray<std::complex<double>> ca(uninitialized, {4, 3});
+        EXPECT_EQ(ca.size(), 12u);
+        EXPECT_EQ(ca(3, 2), std::complex<double>());
+
+        xarray<double> big({300, 500}, 2.5);
+        EXPECT_EQ(big(299, 499), 2.5);
+        big.fill(1.5);
+        EXPECT_TRUE(std::all_of(big.cbegin(), big.cend(), [](double v) { return v == 1.5; }));
+    }
+
     TEST(xarray, strided_valued_constructor)
     {
         central_major_result<> cmr;
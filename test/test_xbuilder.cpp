@@ -13,13 +13,17 @@
 
 #include "gtest/gtest.h"
 #include "test_common_macros.hpp"
+#include "xtensor/xadapt.hpp"
 #include "xtensor/xbuilder.hpp"
 #include "xtensor/xarray.hpp"
 #include "xtensor/xtensor.hpp"
 #include "xtensor/xfixed.hpp"
 
 #include "xtensor/xio.hpp"
+#include <algorithm>
+#include <complex>
 #include <sstream>
+#include <vector>
 
 namespace xt
 {
@@ -702,4 +706,26 @@ namespace xt
         b = std::is_same<decltype(ed3), xarray<double>>::value;
         EXPECT_TRUE(b);
     }
+
+    TEST(xbuilder, parallel_fill)
+    {
+        xtensor<double, 2> a = empty<double>({400, 300});
+        a = zeros<double>({400, 300});
+        EXPECT_TRUE(std::all_of(a.cbegin(), a.cend(), [](double v) { return v == 0.; }));
+
+        auto f = full_like(a, 3.5);
+        EXPECT_TRUE(std::all_of(f.cbegin(), f.cend(), [](double v) { return v == 3.5; }));
+        auto o = ones_like(a);
+        EXPECT_TRUE(std::all_of(o.cbegin(), o.cend(), [](double v) { return v == 1.; }));
+
+        xarray<std::complex<double>> c = xarray<std::complex<double>>::from_shape({200, 700});
+        c.fill(std::complex<double>(1., 2.));
+        EXPECT_EQ(c(199, 699), std::complex<double>(1., 2.));
+
+        // the bits of std::vector<bool> are filled serially
+        std::vector<bool> v(std::size_t(1) << 18, false);
+        auto va = adapt(v, std::vector<std::size_t>({v.size()}));
+        va.fill(true);
+        EXPECT_TRUE(std::all_of(v.cbegin(), v.cend(), [](bool x) { return x; }));
+    }
 }
@@ -11,13 +11,109 @@
 
 #include "xtensor/xbroadcast.hpp"
 #include "xtensor/xchunked_array.hpp"
+#include "xtensor/xchunk_store.hpp"
 #include "xtensor/xcsv.hpp"
+#include "xtensor/xdynamic_view.hpp"
+#include "xtensor/xmanipulation.hpp"
+#include "xtensor/xmath.hpp"
 #include "xtensor/xnoalias.hpp"
+#include "xtensor/xview.hpp"
+
+#include "test_common_macros.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#include <process.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
+#endif
 
 namespace xt
 {
     using in_memory_chunked_array = xchunked_array<xarray<xarray<double>>>;
 
+    // Unique directory in the temporary directory of the system, removed
+    // with the chunk files it holds at the end of the test
+    class temporary_directory
+    {
+    public:
+
+        explicit temporary_directory(const std::string& name)
+        {
+#ifdef _WIN32
+            static int counter = 0;
+            const char* base = std::getenv("TEMP");
+            m_path = std::string(base != nullptr ? base : ".") + "\\xtensor_" + name + "_"
+                + std::to_string(_getpid()) + "_" + std::to_string(counter++);
+            if (_mkdir(m_path.c_str()) != 0)
+            {
+                throw std::runtime_error("failed to create " + m_path);
+            }
+#else
+            const char* base = std::getenv("TMPDIR");
+            std::string pattern = std::string(base != nullptr ? base : "/tmp") + "/xtensor_" + name + "_XXXXXX";
+            std::vector<char> buffer(pattern.cbegin(), pattern.cend());
+            buffer.push_back('\0');
+            if (mkdtemp(buffer.data()) == nullptr)
+            {
+                throw std::runtime_error("failed to create " + pattern);
+            }
+            m_path = buffer.data();
+#endif
+        }
+
+        ~temporary_directory()
+        {
+#ifdef _WIN32
+            _finddata_t entry;
+            intptr_t handle = _findfirst((m_path + "\\*").c_str(), &entry);
+            if (handle != -1)
+            {
+                do
+                {
+                    std::remove((m_path + "\\" + entry.name).c_str());
+                } while (_findnext(handle, &entry) == 0);
+                _findclose(handle);
+            }
+            _rmdir(m_path.c_str());
+#else
+            if (DIR* dir = opendir(m_path.c_str()))
+            {
+                while (dirent* entry = readdir(dir))
+                {
+                    std::string name = entry->d_name;
+                    if (name != "." && name != "..")
+                    {
+                        std::remove((m_path + "/" + name).c_str());
+                    }
+                }
+                closedir(dir);
+            }
+            rmdir(m_path.c_str());
+#endif
+        }
+
+        temporary_directory(const temporary_directory&) = delete;
+        temporary_directory& operator=(const temporary_directory&) = delete;
+
+        const std::string& path() const
+        {
+            return m_path;
+        }
+
+    private:
+
+        std::string m_path;
+    };
+
     TEST(xchunked_array, indexed_access)
     {
         auto a = chunked_array<double>({10, 10, 10}, {2, 3, 4});
@@ -125,6 +221,21 @@ namespace xt
         }
     }
 
+    TEST(xchunked_array, assign_many_chunks)
+    {
+        // enough chunks to be split among threads, including edge chunks
+        std::vector<std::size_t> shape = {101, 67};
+        std::vector<std::size_t> chunk_shape = {8, 5};
+        auto a = chunked_array<double>(shape, chunk_shape);
+        xt::xarray<double> b = arange(101 * 67).reshape({101, 67});
+
+        a = 2. * b + 1.;
+        EXPECT_EQ(a, 2. * b + 1.);
+
+        a += 1.;
+        EXPECT_EQ(a, 2. * b + 2.);
+    }
+
     TEST(xchunked_array, noalias)
     {
         std::vector<std::size_t> shape = {10, 10, 10};
@@ -137,6 +248,38 @@ namespace xt
         EXPECT_EQ(a, b);
     }
 
+    TEST(xchunked_array, reducers)
+    {
+        // edge chunks along every axis
+        std::vector<std::size_t> chunk_shape = {4, 3, 5};
+        xt::xarray<double> b = arange(9 * 7 * 10).reshape({9, 7, 10});
+        auto a = chunked_array(b, chunk_shape);
+
+        EXPECT_EQ(sum(a)(), sum(b)());
+        EXPECT_EQ(amax(a)(), amax(b)());
+        EXPECT_EQ(sum(a, evaluation_strategy::immediate)(), sum(b)());
+
+        xt::xarray<double> s0 = sum(a, {0});
+        EXPECT_EQ(s0, xt::xarray<double>(sum(b, {0})));
+        xt::xarray<double> s12 = sum(a, {1, 2});
+        EXPECT_EQ(s12, xt::xarray<double>(sum(b, {1, 2})));
+        xt::xarray<double> m02 = mean(a, {0, 2});
+        EXPECT_TRUE(allclose(m02, mean(b, {0, 2})));
+        xt::xarray<double> s1k = sum(a, {1}, keep_dims | evaluation_strategy::immediate);
+        EXPECT_EQ(s1k, xt::xarray<double>(sum(b, {1}, keep_dims)));
+        xt::xarray<double> s2i = sum(a, {2}, initial(5.));
+        EXPECT_EQ(s2i, xt::xarray<double>(sum(b, {2}, initial(5.))));
+
+        // no chunk to reduce
+        auto e = chunked_array<double>({0, 5}, {2, 2});
+        EXPECT_EQ(e.grid_size(), 0u);
+        EXPECT_EQ(sum(e)(), 0.);
+        xt::xarray<double> e0 = sum(e, {0});
+        EXPECT_EQ(e0, zeros<double>({5}));
+        xt::xarray<double> e0i = sum(e, {0}, initial(2.));
+        EXPECT_EQ(e0i, xt::xarray<double>({2., 2., 2., 2., 2.}));
+    }
+
     TEST(xchunked_array, chunk_iterator)
     {
         std::vector<std::size_t> shape = {10, 10, 10};
@@ -166,4 +309,188 @@ namespace xt
         std::advance(it, 2);
         EXPECT_EQ(*((*it).begin()), a(0, 0, 4));
     }
+
+    TEST(xchunked_array, file_store)
+    {
+        std::vector<std::size_t> shape = {10, 10, 10};
+        std::vector<std::size_t> chunk_shape = {2, 3, 4};
+        temporary_directory dir("file_store");
+        const std::string& path = dir.path();
+        xt::xarray<double> b = arange(1000).reshape({10, 10, 10});
+        {
+            auto a = chunked_file_array<double>(shape, chunk_shape, path, 2);
+            noalias(a) = b;
+            EXPECT_EQ(a(3, 9, 8), b(3, 9, 8));
+            a(0, 0, 0) = -1.;
+        }
+
+        // chunks are read back from the files
+        b(0, 0, 0) = -1.;
+        auto a = chunked_file_array<double>(shape, chunk_shape, path, 3);
+        EXPECT_EQ(a, b);
+
+        a += 1.;
+        a.chunks().flush();
+        const auto c = chunked_file_array<double>(shape, chunk_shape, path);
+        EXPECT_EQ(c, b + 1.);
+        XT_EXPECT_THROW(a = xt::xarray<double>::from_shape({2, 2}), std::runtime_error);
+
+        temporary_directory fill_dir("file_store_fill");
+        const auto d = chunked_file_array<double>({4, 4}, {2, 2}, fill_dir.path(), 1, 7.);
+        EXPECT_EQ(d(3, 3), 7.);
+        EXPECT_EQ(d.chunks().size(), 4u);
+    }
+
+    TEST(xchunked_array, file_store_references)
+    {
+        temporary_directory dir("file_store_references");
+        xt::xarray<double> b = arange(100.).reshape({10, 10});
+        auto a = chunked_file_array(b, std::vector<std::size_t>({5, 5}), dir.path());
+
+        // references into distinct chunks stay valid while both are cached
+        const auto& ca = a;
+        const double& r0 = ca(0, 0);
+        const double& r1 = ca(9, 9);
+        EXPECT_EQ(r0, b(0, 0));
+        EXPECT_EQ(r1, b(9, 9));
+        EXPECT_EQ(ca(0, 0) + ca(9, 9), b(0, 0) + b(9, 9));
+        EXPECT_EQ(view(a, range(0, 5), all()) + view(a, range(5, 10), all()),
+                  view(b, range(0, 5), all()) + view(b, range(5, 10), all()));
+
+        // the assigned expression reads chunks that are overwritten
+        a = flip(a, 0);
+        EXPECT_EQ(a, flip(b, 0));
+
+        // strided views of the array are assigned to in-memory chunked
+        // arrays without concurrent accesses to its cache
+        auto c = chunked_array(flip(a, 0), std::vector<std::size_t>({2, 5}));
+        EXPECT_EQ(c, b);
+        auto d = chunked_array<double>({5, 10}, {2, 5});
+        d = strided_view(a, {range(0, 10, 2), all()});
+        EXPECT_EQ(d, view(flip(b, 0), range(0, 10, 2), all()));
+
+        a = dynamic_view(a, {all(), keep(9, 8, 7, 6, 5, 4, 3, 2, 1, 0)});
+        EXPECT_EQ(a, flip(flip(b, 0), 1));
+    }
+
+    TEST(xchunked_array, sparse_store)
+    {
+        auto a = chunked_sparse_array<double>({10, 10}, {5, 5}, 1.);
+        const auto& ca = a;
+        EXPECT_EQ(ca(3, 7), 1.);
+        EXPECT_EQ(a.chunks().allocated_chunks(), 0u);
+
+        a(3, 7) = 2.;
+        EXPECT_TRUE(a.chunks().is_allocated(1));
+        EXPECT_EQ(a.chunks().allocated_chunks(), 1u);
+        EXPECT_EQ(ca(3, 7), 2.);
+        EXPECT_EQ(ca(3, 6), 1.);
+
+        // chunks holding only the fill value are released on assignment
+        xt::xarray<double> b = ones<double>({10, 10});
+        b(8, 2) = 4.;
+        a = b;
+        EXPECT_EQ(a.chunks().allocated_chunks(), 1u);
+        EXPECT_TRUE(a.chunks().is_allocated(2));
+        EXPECT_EQ(a, b);
+        EXPECT_EQ(sum(a)(), sum(b)());
+
+        a(0, 0) = 1.;
+        EXPECT_EQ(a.chunks().allocated_chunks(), 2u);
+        EXPECT_EQ(a.chunks().compact(), 1u);
+        EXPECT_EQ(a.chunks().allocated_chunks(), 1u);
+
+        auto c = a;
+        EXPECT_EQ(c, b);
+        a += 1.;
+        EXPECT_EQ(a.chunks().allocated_chunks(), 4u);
+        EXPECT_EQ(a, b + 1.);
+        EXPECT_EQ(c.chunks().allocated_chunks(), 1u);
+    }
+
+    TEST(xchunked_array, compressed_store)
+    {
+        xt::xarray<int> b = arange<int>(6000).reshape({100, 60}) / 7;
+        auto a = chunked_compressed_array<int>({100, 60}, {10, 20}, 2);
+        a = b;
+        EXPECT_EQ(a, b);
+        a.chunks().flush();
+        EXPECT_LT(a.chunks().compressed_size(), b.size() * sizeof(int) / 2);
+
+        a += 1;
+        auto c = a;
+        EXPECT_EQ(a, b + 1);
+        EXPECT_EQ(c, b + 1);
+
+        auto d = chunked_compressed_array(b, std::vector<std::size_t>({30, 30}), 3);
+        EXPECT_EQ(d, b);
+        EXPECT_EQ(sum(d)(), sum(b)());
+
+        const auto e = chunked_compressed_array<double>({4, 4}, {2, 2}, 1, 7.);
+        EXPECT_EQ(e(3, 3), 7.);
+        EXPECT_EQ(e.chunks().compressed_size(), 0u);
+
+        // references into distinct chunks stay valid while both are cached
+        const auto& cd = d;
+        const int& r0 = cd(0, 0);
+        const int& r1 = cd(99, 59);
+        EXPECT_EQ(r0, b(0, 0));
+        EXPECT_EQ(r1, b(99, 59));
+    }
+
+    TEST(xchunked_array, prefetch)
+    {
+        std::vector<std::size_t> chunk_shape = {10, 10};
+        xt::xarray<double> b = arange(2000.).reshape({40, 50});
+
+        auto a = chunked_compressed_array(b, chunk_shape, 2);
+        a.chunks().set_prefetch_depth(3);
+        const auto& ca = a;
+        double total = 0.;
+        for (auto it = ca.chunk_cbegin(); it != ca.chunk_cend(); ++it)
+        {
+            total += sum(*it)();
+        }
+        EXPECT_EQ(total, sum(b)());
+        a += 1.;
+        EXPECT_EQ(a, b + 1.);
+
+        temporary_directory dir("prefetch");
+        auto f = chunked_file_array(b, chunk_shape, dir.path(), 2);
+        f.chunks().flush();
+        f.chunks().set_prefetch_depth(2);
+        EXPECT_EQ(sum(f)(), sum(b)());
+        EXPECT_EQ(f, b);
+    }
+
+    TEST(xchunked_array, stepper)
+    {
+        xt::xarray<double> b = arange(360.).reshape({12, 30});
+        xt::xarray<double> row = arange(30.);
+        std::vector<std::vector<std::size_t>> chunk_shapes = {{4, 8}, {5, 7}};
+        for (const auto& chunk_shape: chunk_shapes)
+        {
+            auto a = chunked_array(b, chunk_shape);
+            const auto& ca = a;
+
+            EXPECT_TRUE(std::equal(ca.cbegin(), ca.cend(), b.cbegin()));
+            EXPECT_TRUE(std::equal(ca.crbegin(), ca.crend(), b.crbegin()));
+            EXPECT_TRUE(std::equal(ca.template cbegin<layout_type::column_major>(),
+                                   ca.template cend<layout_type::column_major>(),
+                                   b.template cbegin<layout_type::column_major>()));
+
+            xt::xarray<double> c = a + 1.;
+            EXPECT_EQ(c, b + 1.);
+            xt::xarray<double> d = a * row;
+            EXPECT_EQ(d, b * row);
+            xt::xarray<double> v = view(a, range(3, 10), range(5, 27));
+            EXPECT_EQ(v, view(b, range(3, 10), range(5, 27)));
+
+            for (auto it = a.begin(); it != a.end(); ++it)
+            {
+                *it += 1.;
+            }
+            EXPECT_EQ(a, b + 1.);
+        }
+    }
 }
@@ -59,4 +59,21 @@ namespace xt
         EXPECT_EQ(ref, a);
         EXPECT_EQ(ref, b);
     }
+
+    TEST(xchunked_view, assign_edge_chunks)
+    {
+        std::vector<std::size_t> shape = {50, 41};
+        std::vector<std::size_t> chunk_shape = {7, 3};
+        xarray<double> a = arange(0, 50 * 41).reshape(shape);
+        xarray<double> b(shape);
+
+        as_chunked(b, chunk_shape) = a;
+        EXPECT_EQ(a, b);
+
+        auto c = chunked_array<double>(shape, chunk_shape);
+        c = a;
+        xarray<double> d(shape);
+        as_chunked(d, std::vector<std::size_t>({5, 5})) = c;
+        EXPECT_EQ(a, d);
+    }
 }
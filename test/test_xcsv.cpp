@@ -15,6 +15,9 @@
 #include "xtensor/xcsv.hpp"
 #include "xtensor/xmath.hpp" 
 #include "xtensor/xio.hpp" 
+#include "xtensor/xview.hpp"
+
+#include "test_common_macros.hpp"
 
 namespace xt
 {
@@ -55,6 +58,103 @@ namespace xt
         ASSERT_TRUE(all(equal(res, exp)));
     }
 
+    TEST(xcsv, load_large)
+    {
+        // more rows than a parallel chunk, with comments, empty lines,
+        // CRLF line endings and trailing delimiters
+        std::size_t nbrow = 100000;
+        std::stringstream source;
+        source << "a,b,c\n";
+        for (std::size_t i = 0; i < nbrow; ++i)
+        {
+            if (i % 1000 == 0)
+            {
+                source << "# comment\r\n\n";
+            }
+            source << i << ",-" << i << ".5," << i << "e-3" << (i % 2 == 0 ? ",\r\n" : "\n");
+        }
+
+        auto res = load_csv<double>(source, ',', 1, 90000);
+        ASSERT_EQ(res.shape()[0], 90000u);
+        ASSERT_EQ(res.shape()[1], 3u);
+        EXPECT_EQ(res(0, 0), 0.);
+        EXPECT_EQ(res(12345, 0), 12345.);
+        EXPECT_EQ(res(12345, 1), -12345.5);
+        EXPECT_EQ(res(12345, 2), 12.345);
+        EXPECT_EQ(res(89999, 1), -89999.5);
+
+        // batches of rows read from the same stream
+        std::stringstream batch_source;
+        for (std::size_t i = 0; i < 10; ++i)
+        {
+            batch_source << i << ',' << 2 * i << '\n';
+        }
+        auto batch0 = load_csv<double>(batch_source, ',', 0, 4);
+        auto batch1 = load_csv<double>(batch_source, ',', 0, 4);
+        auto batch2 = load_csv<double>(batch_source, ',', 0, 4);
+        ASSERT_EQ(batch0.shape()[0], 4u);
+        ASSERT_EQ(batch1.shape()[0], 4u);
+        ASSERT_EQ(batch2.shape()[0], 2u);
+        EXPECT_EQ(batch1(0, 0), 4.);
+        EXPECT_EQ(batch2(1, 1), 18.);
+        EXPECT_TRUE(batch_source.eof());
+
+        std::stringstream int_source("1, -2\n2147483647,-2147483648\n");
+        auto ires = load_csv<int>(int_source);
+        xtensor<int, 2> iexp = {{1, -2}, {2147483647, -2147483647 - 1}};
+        EXPECT_EQ(ires, iexp);
+
+        // cells that are not plain decimal numbers follow std::stod
+        std::stringstream hex_source("0x1p3, 1e ,2.5 \n");
+        auto hres = load_csv<double>(hex_source);
+        EXPECT_EQ(hres(0, 0), 8.);
+        EXPECT_EQ(hres(0, 1), 1.);
+        EXPECT_EQ(hres(0, 2), 2.5);
+
+        std::stringstream bad_source("1,2\n3\n");
+        XT_EXPECT_THROW(load_csv<double>(bad_source), std::runtime_error);
+        std::stringstream overflow_source("4294967296\n");
+        XT_EXPECT_THROW(load_csv<int>(overflow_source), std::out_of_range);
+    }
+
+    TEST(xcsv, load_columns)
+    {
+        std::string source =
+            "# measures\n"
+            "id, name, x, y\n"
+            "1, a, 1.5, 10\n"
+            "2, b, 2.5, 20\n"
+            "3, c, 3.5, 30";
+
+        std::stringstream index_stream(source);
+        auto by_index = load_csv_select<double>(index_stream, {3, 0}, ',', 2);
+        xtensor<double, 2> exp = {{10., 1.}, {20., 2.}, {30., 3.}};
+        EXPECT_EQ(by_index, exp);
+
+        std::stringstream name_stream(source);
+        auto by_name = load_csv_select<double>(name_stream, {"y", "id"});
+        EXPECT_EQ(by_name, exp);
+
+        std::stringstream single_stream(source);
+        auto single = load_csv_select<double>(single_stream, {2}, ',', 2);
+        xtensor<double, 2> exp_single = {{1.5}, {2.5}, {3.5}};
+        EXPECT_EQ(single, exp_single);
+
+        std::stringstream columns_stream(source);
+        auto columns = load_csv_columns<std::string, double, int>(columns_stream, {"name", "x", "id"}, ',', 0, 2);
+        xtensor<std::string, 1> exp_name = {"a", "b"};
+        xtensor<double, 1> exp_x = {1.5, 2.5};
+        xtensor<int, 1> exp_id = {1, 2};
+        EXPECT_EQ(std::get<0>(columns), exp_name);
+        EXPECT_EQ(std::get<1>(columns), exp_x);
+        EXPECT_EQ(std::get<2>(columns), exp_id);
+
+        std::stringstream missing_stream(source);
+        XT_EXPECT_THROW(load_csv_select<double>(missing_stream, {"z"}), std::runtime_error);
+        std::stringstream types_stream(source);
+        XT_EXPECT_THROW(load_csv_columns<double>(types_stream, {0, 1}), std::runtime_error);
+    }
+
     TEST(xcsv, dump_double)
     {
         xtensor<double, 2> data
@@ -66,4 +166,55 @@ namespace xt
         dump_csv(res, data);
         ASSERT_EQ("1,2,3,4\n10,12,15,18\n", res.str());
     }
+
+    TEST(xcsv, dump_formats)
+    {
+        xtensor<double, 2> data
+            {{0.1, 1.0 / 3.0, -2.5},
+             {1e300, 0.0, 123456.789}};
+
+        // the precision of the stream is used by default, as with operator<<
+        std::stringstream default_res;
+        default_res.precision(3);
+        dump_csv(default_res, data);
+        EXPECT_EQ("0.1,0.333,-2.5\n1e+300,0,1.23e+05\n", default_res.str());
+
+        std::stringstream showpos_res;
+        showpos_res << std::showpos;
+        dump_csv(showpos_res, view(data, keep(0)));
+        EXPECT_EQ("+0.1,+0.333333,-2.5\n", showpos_res.str());
+
+        std::stringstream shortest;
+        dump_csv(shortest, data, ',', csv_float_format::shortest);
+        EXPECT_EQ("0.1,0.3333333333333333,-2.5\n1e+300,0,123456.789\n", shortest.str());
+        xtensor<double, 2> res = load_csv<double>(shortest);
+        EXPECT_EQ(res, data);
+
+        std::stringstream fixed;
+        dump_csv(fixed, view(data, keep(0)), ';', csv_float_format::fixed, 3);
+        EXPECT_EQ("0.100;0.333;-2.500\n", fixed.str());
+
+        std::stringstream scientific;
+        dump_csv(scientific, view(data, keep(0)), ',', csv_float_format::scientific, 2);
+        EXPECT_EQ("1.00e-01,3.33e-01,-2.50e+00\n", scientific.str());
+
+        xtensor<int, 2> ints = {{-1, 0}, {2147483647, -2147483647 - 1}};
+        std::stringstream int_res;
+        dump_csv(int_res, ints);
+        EXPECT_EQ("-1,0\n2147483647,-2147483648\n", int_res.str());
+    }
+
+    TEST(xcsv, dump_large)
+    {
+        // more rows than a formatting block
+        xtensor<double, 2> data = xtensor<double, 2>::from_shape({200000, 3});
+        for (std::size_t i = 0; i < data.size(); ++i)
+        {
+            data.flat(i) = static_cast<double>(i) / 8.;
+        }
+        std::stringstream res;
+        dump_csv(res, data * 2., ',', csv_float_format::shortest);
+        xtensor<double, 2> loaded = load_csv<double>(res);
+        EXPECT_EQ(loaded, data * 2.);
+    }
 }
@@ -9,10 +9,13 @@
 
 #include <complex>
 #include <limits>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "xtensor/xtensor.hpp"
+#include "xtensor/xbuilder.hpp"
 #include "xtensor/xhistogram.hpp"
+#include "xtensor/xmath.hpp"
 #include "xtensor/xrandom.hpp"
 
 namespace xt
@@ -70,6 +73,182 @@ namespace xt
         }
     }
 
+    TEST(xhistogram, histogram_unequal_bins)
+    {
+        xt::xtensor<double, 1> data = {4., 0.5, 2., 1., 3.5, std::numeric_limits<double>::quiet_NaN(), 1.5, 5.};
+        xt::xtensor<double, 1> bin_edges = {1., 2., 4.};
+
+        {
+            xt::xtensor<double, 1> count = xt::histogram(data, bin_edges);
+            xt::xtensor<double, 1> expected = {2., 3.};
+            EXPECT_EQ(count, expected);
+        }
+
+        {
+            xt::xtensor<double, 1> weights = {1., 1., 2., 3., 4., 1., 5., 1.};
+            xt::xtensor<double, 1> count = xt::histogram(data, bin_edges, weights);
+            xt::xtensor<double, 1> expected = {8., 7.};
+            EXPECT_EQ(count, expected);
+        }
+    }
+
+    TEST(xhistogram, histogram_large)
+    {
+        xt::xtensor<double, 1> data = xt::arange<double>(100000.);
+
+        xt::xtensor<double, 1> count = xt::histogram(data, std::size_t(10));
+        EXPECT_EQ(count, 10000. * xt::ones<double>({10}));
+
+        xt::xtensor<double, 1> bin_edges = {0., 10., 1000., 99999.};
+        xt::xtensor<double, 1> count_edges = xt::histogram(data, bin_edges);
+        xt::xtensor<double, 1> expected = {10., 990., 99000.};
+        EXPECT_EQ(count_edges, expected);
+
+        xt::xtensor<int, 1> ints = xt::arange<int>(100000) % 7;
+        xt::xtensor<int, 1> bc = xt::bincount(ints);
+        xt::xtensor<int, 1> expected_bc = {14286, 14286, 14286, 14286, 14286, 14285, 14285};
+        EXPECT_EQ(bc, expected_bc);
+    }
+
+    TEST(xhistogram, histogramdd)
+    {
+        xt::xtensor<double, 2> samples = {{0.5, 1.5}, {1.5, 0.5}, {1.5, 1.5}, {2., 2.}, {3., 0.}};
+        std::vector<xt::xtensor<double, 1>> bin_edges = {{0., 1., 2.}, {0., 1., 2.}};
+
+        {
+            xt::xarray<double> count = xt::histogramdd(samples, bin_edges);
+            xt::xarray<double> expected = {{0., 1.}, {1., 2.}};
+            EXPECT_EQ(count, expected);
+        }
+
+        {
+            xt::xarray<double> prob = xt::histogramdd(samples, bin_edges, true);
+            xt::xarray<double> expected = {{0., 0.2}, {0.2, 0.4}};
+            EXPECT_TRUE(xt::allclose(prob, expected));
+        }
+
+        {
+            xt::xarray<double> count = xt::histogramdd(samples, std::size_t(2));
+            xt::xarray<double> expected = {{1., 2.}, {1., 1.}};
+            EXPECT_EQ(count, expected);
+        }
+
+        {
+            // a single sample lies in the middle of a range of width 1
+            xt::xtensor<double, 2> single = {{1., 2.}};
+            xt::xarray<double> count = xt::histogramdd(single, std::size_t(2));
+            xt::xarray<double> expected = {{0., 0.}, {0., 1.}};
+            EXPECT_EQ(count, expected);
+        }
+    }
+
+    TEST(xhistogram, histogram2d)
+    {
+        xt::xtensor<double, 1> x = {0.5, 1.5, 1.5, 2., 3.};
+        xt::xtensor<double, 1> y = {1.5, 0.5, 1.5, 2., 0.};
+        xt::xtensor<double, 1> bin_edges = {0., 1., 2.};
+
+        {
+            xt::xtensor<double, 2> count = xt::histogram2d(x, y, bin_edges, bin_edges);
+            xt::xtensor<double, 2> expected = {{0., 1.}, {1., 2.}};
+            EXPECT_EQ(count, expected);
+        }
+
+        {
+            xt::xtensor<double, 1> weights = {1., 2., 3., 4., 5.};
+            xt::xtensor<double, 2> count = xt::histogram2d(x, y, bin_edges, bin_edges, weights);
+            xt::xtensor<double, 2> expected = {{0., 1.}, {2., 7.}};
+            EXPECT_EQ(count, expected);
+        }
+
+        {
+            xt::xtensor<double, 2> count = xt::histogram2d(x, y, std::size_t(2));
+            xt::xtensor<double, 2> expected = {{1., 2.}, {1., 1.}};
+            EXPECT_EQ(count, expected);
+        }
+
+        {
+            xt::xtensor<double, 1> same_x = {1., 1., 1.};
+            xt::xtensor<double, 1> spread_y = {0., 1., 2.};
+            xt::xtensor<double, 2> count = xt::histogram2d(same_x, spread_y, std::size_t(2));
+            xt::xtensor<double, 2> expected = {{0., 0.}, {1., 2.}};
+            EXPECT_EQ(count, expected);
+
+            xt::xtensor<double, 1> empty = xt::xtensor<double, 1>::from_shape({0});
+            xt::xtensor<double, 2> empty_count = xt::histogram2d(empty, empty, std::size_t(2));
+            EXPECT_EQ(empty_count, xt::zeros<double>({2, 2}));
+        }
+    }
+
+    TEST(xhistogram, histogram_accumulator)
+    {
+        xt::xtensor<double, 1> data = {1., 1., 2., 2., 3., 4.};
+
+        {
+            xt::histogram_accumulator<> acc(std::size_t(3), 1., 4.);
+            acc.update(xt::view(data, xt::range(0, 3)));
+            acc.update(xt::view(data, xt::range(3, _)));
+            xt::xtensor<double, 1> expected = xt::histogram(data, std::size_t(3), 1., 4.);
+            EXPECT_EQ(acc.counts(), expected);
+            EXPECT_EQ(acc.samples(), std::size_t(6));
+            EXPECT_TRUE(xt::allclose(acc.density(), xt::histogram(data, std::size_t(3), 1., 4., true)));
+
+            acc.reset();
+            EXPECT_EQ(acc.counts(), xt::zeros<double>({3}));
+        }
+
+        {
+            xt::xtensor<double, 1> bin_edges = {0., 1., 3.};
+            xt::histogram_accumulator<> acc(bin_edges);
+            xt::histogram_accumulator<> other(bin_edges);
+            acc.update(xt::xtensor<double, 1>{0.5, 2.}, xt::xtensor<double, 1>{2., 3.});
+            other.update(xt::xtensor<double, 1>{2.5, 5.});
+            acc.merge(other);
+            xt::xtensor<double, 1> expected = {2., 4.};
+            EXPECT_EQ(acc.counts(), expected);
+            EXPECT_EQ(acc.samples(), std::size_t(4));
+
+            xt::histogram_accumulator<> different(std::size_t(2), 0., 3.);
+            EXPECT_THROW(acc.merge(different), std::runtime_error);
+        }
+
+        {
+            xt::histogram_accumulator<> acc(std::size_t(2), 0., 2., true);
+            acc.update(xt::xtensor<double, 1>{0.5, 1.5, 2., -0.5, std::numeric_limits<double>::quiet_NaN()});
+            xt::xtensor<double, 1> expected_edges = {-1., 0., 1., 2., 3.};
+            xt::xtensor<double, 1> expected = {1., 1., 1., 1.};
+            EXPECT_EQ(acc.edges(), expected_edges);
+            EXPECT_EQ(acc.counts(), expected);
+
+            xt::histogram_accumulator<> other(std::size_t(2), 0., 2., true);
+            other.update(xt::xtensor<double, 1>{4.5});
+            acc.merge(other);
+            xt::xtensor<double, 1> expected_merged = {1., 1., 1., 1., 0., 1.};
+            EXPECT_EQ(acc.counts(), expected_merged);
+        }
+
+        {
+            // bins are merged by pairs instead of covering the outlier
+            xt::histogram_accumulator<> acc(std::size_t(4), 0., 4., true, 8);
+            acc.update(xt::xtensor<double, 1>{0.5, 1.5, 2.5, 3.5, 9.5});
+            xt::xtensor<double, 1> expected_edges = {0., 2., 4., 6., 8., 10.};
+            xt::xtensor<double, 1> expected = {2., 2., 0., 0., 1.};
+            EXPECT_EQ(acc.edges(), expected_edges);
+            EXPECT_EQ(acc.counts(), expected);
+
+            acc.update(xt::xtensor<double, 1>{1e15});
+            EXPECT_LE(acc.size(), acc.max_bins());
+            EXPECT_EQ(xt::sum(acc.counts())(), 6.);
+
+            // accumulators whose bins were merged a different number of times
+            xt::histogram_accumulator<> other(std::size_t(4), 0., 4., true, 8);
+            other.update(xt::xtensor<double, 1>{0.5, -3.5});
+            acc.merge(other);
+            EXPECT_EQ(acc.samples(), std::size_t(8));
+            EXPECT_EQ(xt::sum(acc.counts())(), 8.);
+        }
+    }
+
     TEST(xhistogram, bincount)
     {
         xtensor<int, 1> data = {1, 2, 3, 1, 1, 1, 1, 2, 3, 2, 3, 3, 3, 3};
@@ -11,13 +11,15 @@
 
 #include "xtensor/xnpy.hpp"
 #include "xtensor/xarray.hpp"
+#include "xtensor/xview.hpp"
 
 #include <fstream>
 #include <cstdint>
 
 namespace xt
 {
-    std::string get_load_filename(std::string const& npy_prefix, layout_type lt = layout_type::row_major)
+    std::string get_load_filename(std::string const& npy_prefix, layout_type lt = layout_type::row_major,
+                                  std::string const& extension = ".npy")
     {
         std::string lts = lt == layout_type::row_major ? "" : "_fortran";
         std::string endianness;
@@ -33,7 +35,7 @@ namespace xt
             endianness = ".unsupported";
             break;
         }
-        return npy_prefix + lts + endianness + ".npy";
+        return npy_prefix + lts + endianness + extension;
     }
 
     TEST(xnpy, load)
@@ -85,6 +87,57 @@ namespace xt
         EXPECT_TRUE(all(equal(iarr1d, iarr1d_loaded)));
     }
 
+    TEST(xnpy, load_mmap)
+    {
+        xarray<double> darr = load_npy<double>(get_load_filename("files/xnpy_files/double"));
+
+        auto darr_mapped = load_npy_mmap<const double>(get_load_filename("files/xnpy_files/double"));
+        EXPECT_EQ(darr_mapped.layout(), layout_type::row_major);
+        EXPECT_TRUE(all(equal(darr, darr_mapped)));
+
+        auto dfarr_mapped = load_npy_mmap<const double, layout_type::column_major>(get_load_filename("files/xnpy_files/double_fortran"));
+        EXPECT_EQ(dfarr_mapped.layout(), layout_type::column_major);
+        EXPECT_TRUE(all(equal(darr, dfarr_mapped)));
+
+        auto barr_mapped = load_npy_mmap<const bool>(get_load_filename("files/xnpy_files/bool"));
+        EXPECT_TRUE(all(equal(load_npy<bool>(get_load_filename("files/xnpy_files/bool")), barr_mapped)));
+
+        // copy-on-write: the file is not modified
+        auto darr_private = load_npy_mmap<double>(get_load_filename("files/xnpy_files/double"));
+        darr_private(0, 0, 0) = 42.;
+        EXPECT_EQ(darr_private(0, 0, 0), 42.);
+        EXPECT_EQ(load_npy<double>(get_load_filename("files/xnpy_files/double"))(0, 0, 0), darr(0, 0, 0));
+
+        EXPECT_THROW(load_npy_mmap<const int>(get_load_filename("files/xnpy_files/double")), std::runtime_error);
+        EXPECT_THROW((load_npy_mmap<const double, layout_type::row_major>(get_load_filename("files/xnpy_files/double_fortran"))),
+                     std::runtime_error);
+    }
+
+    TEST(xnpy, load_slice)
+    {
+        xarray<double> darr = load_npy<double>(get_load_filename("files/xnpy_files/double"));
+
+        xarray<double> rows = load_npy_slice<double>(get_load_filename("files/xnpy_files/double"), range(1, 3));
+        EXPECT_EQ(rows, view(darr, range(1, 3)));
+
+        xarray<double> slab = load_npy_slice<double>(get_load_filename("files/xnpy_files/double"), range(0, 3, 2), all(), 1);
+        EXPECT_EQ(slab, view(darr, range(0, 3, 2), all(), 1));
+
+        xarray<double> elem = load_npy_slice<double>(get_load_filename("files/xnpy_files/double"), 2, -1, 0);
+        EXPECT_EQ(elem(), darr(2, 2, 0));
+
+        auto fslab = load_npy_slice<double, layout_type::column_major>(get_load_filename("files/xnpy_files/double_fortran"),
+                                                                       all(), range(1, 3), keep(0, 2));
+        EXPECT_EQ(fslab.layout(), layout_type::column_major);
+        EXPECT_EQ(fslab, view(darr, all(), range(1, 3), keep(0, 2)));
+
+        xarray<int> iarr = load_npy_slice<int>(get_load_filename("files/xnpy_files/int"), range(placeholders::_, placeholders::_, -2));
+        xarray<int> iexpected = {7, 5, 3};
+        EXPECT_EQ(iarr, iexpected);
+
+        EXPECT_THROW(load_npy_slice<double>(get_load_filename("files/xnpy_files/double"), 3), std::out_of_range);
+    }
+
     bool compare_binary_files(std::string fn1, std::string fn2)
     {
         std::ifstream stream1(fn1, std::ios::in | std::ios::binary);
@@ -99,9 +152,9 @@ namespace xt
     }
 
 
-    std::string get_dump_filename(int n)
+    std::string get_dump_filename(int n, std::string const& extension = ".npy")
     {
-        std::string filename = "files/xnpy_files/test_dump_" + std::to_string(n) + ".npy";
+        std::string filename = "files/xnpy_files/test_dump_" + std::to_string(n) + extension;
         return filename;
     }
 
@@ -152,6 +205,101 @@ namespace xt
         std::remove(filename.c_str());
     }
 
+    TEST(xnpy, writer)
+    {
+        std::string filename = get_dump_filename(2);
+        xarray<double> expected = {{1., 2., 3.}, {4., 5., 6.}, {7., 8., 9.}, {10., 11., 12.}, {13., 14., 15.}};
+
+        {
+            npy_writer<double> writer(filename, {3});
+            writer.append(view(expected, range(0, 2)));
+            writer.append(view(expected, 2));
+            xarray<int, layout_type::column_major> last = {{10, 11, 12}, {13, 14, 15}};
+            writer.append(last);
+            EXPECT_EQ(writer.rows(), std::size_t(5));
+            xarray<double> bad = {1., 2.};
+            EXPECT_THROW(writer.append(bad), std::runtime_error);
+        }
+
+        auto loaded = load_npy<double>(filename);
+        EXPECT_TRUE(all(equal(expected, loaded)));
+
+        {
+            npy_writer<double> writer(filename, {3});
+            writer.close();
+        }
+        auto empty = load_npy<double>(filename);
+        EXPECT_EQ(empty.shape()[0], std::size_t(0));
+        EXPECT_EQ(empty.shape()[1], std::size_t(3));
+
+        std::remove(filename.c_str());
+    }
+
+    TEST(xnpy, npz)
+    {
+        std::string filename = get_dump_filename(3, ".npz");
+        xarray<double> darr = load_npy<double>(get_load_filename("files/xnpy_files/double"));
+        xtensor<int, 1> iarr = {3, 4, 5, 6, 7};
+        xarray<bool, layout_type::column_major> barr = {{true, false}, {false, true}};
+
+        dump_npz(filename, "double", darr, false);
+        dump_npz(filename, "int", iarr);
+        dump_npz(filename, "bool", barr);
+        EXPECT_THROW(dump_npz(filename, "int", iarr), std::runtime_error);
+
+        auto npz = load_npz(filename);
+        std::vector<std::string> expected_names = {"bool", "double", "int"};
+        EXPECT_EQ(npz.names(), expected_names);
+        EXPECT_TRUE(npz.contains("int"));
+        EXPECT_FALSE(npz.contains("float"));
+
+        auto dmapped = npz.get<const double>("double");
+        EXPECT_TRUE(all(equal(darr, dmapped)));
+        auto imapped = load_npz<int>(filename, "int");
+        EXPECT_TRUE(all(equal(iarr, imapped)));
+        auto bmapped = npz.get<const bool, layout_type::column_major>("bool");
+        EXPECT_TRUE(all(equal(barr, bmapped)));
+
+        EXPECT_THROW(npz.get<const double>("float"), std::runtime_error);
+        EXPECT_THROW(npz.get<const int>("double"), std::runtime_error);
+
+        dump_npz(filename, "int", iarr, false);
+        EXPECT_EQ(load_npz(filename).names(), std::vector<std::string>({"int"}));
+
+        std::remove(filename.c_str());
+    }
+
+    TEST(xnpy, npz_numpy)
+    {
+        // written as by numpy.savez: stored entries with zip64 local headers
+        std::string filename = get_load_filename("files/xnpy_files/savez", layout_type::row_major, ".npz");
+        xarray<double> darr = load_npy<double>(get_load_filename("files/xnpy_files/double"));
+        xarray<int> iarr = {3, 4, 5, 6, 7};
+
+        auto npz = load_npz(filename);
+        EXPECT_EQ(npz.names(), std::vector<std::string>({"double", "int"}));
+        auto dmapped = npz.get<const double>("double");
+        EXPECT_TRUE(all(equal(darr, dmapped)));
+        auto imapped = npz.get<const int>("int");
+        EXPECT_TRUE(all(equal(iarr, imapped)));
+        EXPECT_TRUE(all(equal(iarr, load_npz<int>(filename, "int"))));
+
+        // entries are appended to an archive written by another tool
+        std::string dump_filename = get_dump_filename(4, ".npz");
+        {
+            std::ifstream src(filename, std::ios::binary);
+            std::ofstream dst(dump_filename, std::ios::binary);
+            dst << src.rdbuf();
+        }
+        xtensor<float, 1> farr = {1.5f, 2.5f};
+        dump_npz(dump_filename, "float", farr);
+        auto appended = load_npz(dump_filename);
+        EXPECT_EQ(appended.names(), std::vector<std::string>({"double", "float", "int"}));
+        EXPECT_TRUE(all(equal(darr, appended.get<const double>("double"))));
+        EXPECT_TRUE(all(equal(farr, appended.get<const float>("float"))));
+        std::remove(dump_filename.c_str());
+    }
+
     TEST(xnpy, xfunction_cast)
     {
         // compilation test, cf: https://github.com/xtensor-stack/xtensor/issues/1070
@@ -10,9 +10,12 @@
 #include "gtest/gtest.h"
 
 #include <cstddef>
+#include <cstdint>
+#include <vector>
 
 #include "xtensor/xarray.hpp"
 #include "xtensor/xtensor.hpp"
+#include "xtensor/xbuilder.hpp"
 #include "xtensor/xset_operation.hpp"
 
 namespace xt
@@ -27,6 +30,25 @@ namespace xt
         EXPECT_EQ(xt::isin(a, {1, 2}), res);
     }
 
+    TEST(xset_operation, isin_large_set)
+    {
+        xt::xtensor<std::int64_t, 1> a = xt::arange<std::int64_t>(-50, 150);
+        xt::xtensor<std::int64_t, 1> b = xt::arange<std::int64_t>(0, 200, 2);
+        xt::xtensor<bool, 1> res = (a >= 0) && xt::equal(a % 2, 0);
+        EXPECT_EQ(xt::isin(a, b), res);
+        EXPECT_EQ(xt::isin(a, b.begin(), b.end()), res);
+
+        std::vector<double> c(b.begin(), b.end());
+        EXPECT_EQ(xt::isin(a, c), res);
+    }
+
+    TEST(xset_operation, isin_small_set)
+    {
+        xt::xtensor<double, 1> a = {0.5, -0., 3., 2.5, 7.};
+        xt::xtensor<bool, 1> res = {true, true, false, false, true};
+        EXPECT_EQ(xt::isin(a, {7., 0., 0.5}), res);
+    }
+
     TEST(xset_operation, in1d)
     {
         xt::xtensor<int,1> a = {1, 2, 1, 0, 3, 5, 1};
@@ -47,4 +69,27 @@ namespace xt
         EXPECT_EQ(xt::searchsorted(a, v, true), res_right);
         EXPECT_EQ(xt::searchsorted(a, v, false), res_left);
     }
+
+    TEST(xset_operation, searchsorted_nd)
+    {
+        xt::xtensor<double, 1> a = {1., 2., 7., 8., 20.};
+        xt::xtensor<double, 2> v = {{9., 2., 2.}, {3., 22., 0.}};
+        xt::xtensor<size_t, 2> res_right = {{4, 1, 1}, {2, 5, 0}};
+        xt::xtensor<size_t, 2> res_left = {{4, 2, 2}, {2, 5, 0}};
+        EXPECT_EQ(xt::searchsorted(a, v), res_right);
+        EXPECT_EQ(xt::searchsorted(a, v, false), res_left);
+
+        xt::xtensor<double, 2, xt::layout_type::column_major> vc = v;
+        EXPECT_EQ(xt::searchsorted(a, vc), res_right);
+    }
+
+    TEST(xset_operation, searchsorted_sorted_values)
+    {
+        xt::xtensor<int, 1> a = {0, 2, 2, 4, 6};
+        xt::xtensor<int, 1> v = xt::arange<int>(-1, 8);
+        xt::xtensor<size_t, 1> res_right = {0, 0, 1, 1, 3, 3, 4, 4, 5};
+        xt::xtensor<size_t, 1> res_left = {0, 1, 1, 3, 3, 4, 4, 5, 5};
+        EXPECT_EQ(xt::searchsorted(a, v), res_right);
+        EXPECT_EQ(xt::searchsorted(a, v, false), res_left);
+    }
 }
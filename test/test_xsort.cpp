@@ -320,6 +320,67 @@ namespace xt
         }
     }
 
+    TEST(xsort, unique_hash)
+    {
+        xarray<int> a = {5, 3, 1, 3, -2, 5, 1, 1, 7};
+        xtensor<int, 1> ax = {5, 3, 1, -2, 7};
+        EXPECT_EQ(unique(a, unique_method::hash), ax);
+
+        xarray<double> b = {{1., -0., 3.}, {0., 3., 1.}};
+        xtensor<double, 1> bx = {1., 0., 3.};
+        EXPECT_EQ(unique(b, unique_method::hash), bx);
+
+        xtensor<std::int64_t, 1> c = xt::arange<std::int64_t>(1000) % 37;
+        EXPECT_EQ(sort(unique(c, unique_method::hash)), unique(c));
+    }
+
+    TEST(xsort, unique_all)
+    {
+        xarray<int> a = {{4, 2, 4}, {1, 2, 4}};
+
+        auto rs = unique_all(a);
+        xtensor<int, 1> vs = {1, 2, 4};
+        xtensor<std::size_t, 1> is = {3, 1, 0};
+        xtensor<std::size_t, 1> invs = {2, 1, 2, 0, 1, 2};
+        xtensor<std::size_t, 1> cs = {1, 2, 3};
+        EXPECT_EQ(rs.values, vs);
+        EXPECT_EQ(rs.indices, is);
+        EXPECT_EQ(rs.inverse_indices, invs);
+        EXPECT_EQ(rs.counts, cs);
+
+        auto rh = unique_all(a, unique_method::hash);
+        xtensor<int, 1> vh = {4, 2, 1};
+        xtensor<std::size_t, 1> ih = {0, 1, 3};
+        xtensor<std::size_t, 1> invh = {0, 1, 0, 2, 1, 0};
+        xtensor<std::size_t, 1> ch = {3, 2, 1};
+        EXPECT_EQ(rh.values, vh);
+        EXPECT_EQ(rh.indices, ih);
+        EXPECT_EQ(rh.inverse_indices, invh);
+        EXPECT_EQ(rh.counts, ch);
+
+        auto flat = flatten(a);
+        for (std::size_t i = 0; i < flat.size(); ++i)
+        {
+            EXPECT_EQ(rh.values(rh.inverse_indices(i)), flat(i));
+        }
+
+        auto rc = unique_counts(a, unique_method::hash);
+        EXPECT_EQ(rc.values, vh);
+        EXPECT_EQ(rc.counts, ch);
+
+        auto ri = unique_inverse(a);
+        EXPECT_EQ(ri.values, vs);
+        EXPECT_EQ(ri.inverse_indices, invs);
+    }
+
+    TEST(xsort, setdiff1d_hash)
+    {
+        xarray<std::int64_t> ar1 = {{5, 6, 7}, {4, 4, 4}, {1, 2, 3}};
+        xarray<std::int64_t> ar2 = {4, 1};
+        xtensor<std::int64_t, 1> out = {5, 6, 7, 2, 3};
+        EXPECT_EQ(setdiff1d(ar1, ar2, unique_method::hash), out);
+    }
+
     template <class T>
     bool check_partition(T& arr, std::size_t pos)
     {
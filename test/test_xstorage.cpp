@@ -11,7 +11,9 @@
 #include "test_common_macros.hpp"
 #include "xtensor/xtensor_config.hpp"
 #include "xtensor/xstorage.hpp"
+#include <complex>
 #include <numeric>
+#include <stdexcept>
 
 namespace xt
 {
@@ -53,6 +55,53 @@ namespace xt
         }
     }
 
+    namespace
+    {
+        struct throwing_element
+        {
+            static int count;
+            static int limit;
+
+            throwing_element()
+            {
+                if (count == limit)
+                {
+                    XTENSOR_THROW(std::runtime_error, "throwing_element");
+                }
+                ++count;
+            }
+
+            ~throwing_element()
+            {
+                --count;
+            }
+
+            double value = 1.;
+        };
+
+        int throwing_element::count = 0;
+        int throwing_element::limit = -1;
+    }
+
+    TEST(uvector, uninitialized)
+    {
+        uvector<std::complex<double>> a(10, uninitialized);
+        EXPECT_EQ(size_t(10), a.size());
+        EXPECT_EQ(std::complex<double>(0.), a[3]);
+
+        {
+            uvector<throwing_element> b(10, uninitialized);
+            EXPECT_EQ(10, throwing_element::count);
+            EXPECT_EQ(1., b[9].value);
+        }
+        EXPECT_EQ(0, throwing_element::count);
+
+        throwing_element::limit = 5;
+        XT_EXPECT_THROW(uvector<throwing_element>(10, uninitialized), std::runtime_error);
+        EXPECT_EQ(0, throwing_element::count);
+        throwing_element::limit = -1;
+    }
+
     TEST(uvector, access)
     {
         vector_type a(10);
@@ -8,12 +8,16 @@
 ****************************************************************************/
 
 #include <initializer_list>
+#include <numeric>
 #include <type_traits>
 #include <tuple>
 #include <complex>
+#include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "test_common_macros.hpp"
+#include "xtensor/xallocator.hpp"
 #include "xtensor/xtensor.hpp"
 #include "xtensor/xarray.hpp"
 #include "xtensor/xfixed.hpp"
@@ -207,6 +211,154 @@ namespace xt
         XT_EXPECT_NO_THROW(arr_t c = a);
     }
 
+    TEST(utils, allocation_statistics)
+    {
+        using arr_t = xarray<double, layout_type::row_major,
+                             tracking_allocator<double, std::allocator<double>, alloc_tracking::policy::stats>>;
+
+        arr_t a = {{1, 2, 3}, {5, 6, 7}};
+        alloc_tracking::reset_statistics();
+        alloc_tracking::enable();
+        {
+            arr_t b = a + 123;
+            {
+                alloc_tracking::scoped_tag tag("hot_loop");
+                arr_t c = b * 2;
+                EXPECT_EQ(c(1, 2), 260.);
+            }
+            alloc_tracking::statistics s = alloc_tracking::total_statistics();
+            EXPECT_EQ(s.allocations, 2u);
+            EXPECT_EQ(s.deallocations, 1u);
+            EXPECT_EQ(s.live_bytes(), 6 * sizeof(double));
+            EXPECT_EQ(s.peak_live_bytes, 12 * sizeof(double));
+            EXPECT_EQ(s.size_histogram[6], 2u);
+
+            EXPECT_EQ(alloc_tracking::type_statistics<double>().allocations, 2u);
+            alloc_tracking::statistics ts = alloc_tracking::tag_statistics("hot_loop");
+            EXPECT_EQ(ts.allocations, 1u);
+            EXPECT_EQ(ts.allocated_bytes, 6 * sizeof(double));
+            EXPECT_EQ(alloc_tracking::tag_statistics("unknown").allocations, 0u);
+        }
+        alloc_tracking::disable();
+
+        alloc_tracking::statistics s = alloc_tracking::total_statistics();
+        EXPECT_EQ(s.live_bytes(), 0u);
+        alloc_tracking::reset_statistics();
+        EXPECT_EQ(alloc_tracking::total_statistics().allocations, 0u);
+
+        // buffers allocated before the reset are freed while tracking
+        {
+            arr_t b = a + 1;
+            alloc_tracking::reset_statistics();
+            alloc_tracking::enable();
+            const alloc_tracking::tag hot_loop("hot_loop");
+            {
+                arr_t c = a * 2;
+                alloc_tracking::scoped_tag t(hot_loop);
+                arr_t d = a * 3;
+            }
+            EXPECT_EQ(alloc_tracking::tag_statistics(hot_loop).allocations, 1u);
+        }
+        alloc_tracking::disable();
+        s = alloc_tracking::total_statistics();
+        EXPECT_EQ(s.live_bytes(), 0u);
+        EXPECT_EQ(s.peak_live_bytes, 12 * sizeof(double));
+        alloc_tracking::reset_statistics();
+
+        // the tags registered beyond max_tracked_tags share an overflow slot
+        std::vector<std::string> names;
+        for (std::size_t i = 0; i <= alloc_tracking::max_tracked_tags; ++i)
+        {
+            names.push_back("overflow_" + std::to_string(i));
+            alloc_tracking::tag t(names.back().c_str());
+        }
+        alloc_tracking::enable();
+        {
+            alloc_tracking::scoped_tag t(names.back().c_str());
+            arr_t c = a * 2;
+        }
+        alloc_tracking::disable();
+        EXPECT_EQ(alloc_tracking::tag_statistics(names.back().c_str()).allocations, 1u);
+        for (std::size_t i = 0; i + 1 < alloc_tracking::max_tracked_tags; ++i)
+        {
+            EXPECT_EQ(alloc_tracking::tag_statistics(names[i].c_str()).allocations, 0u);
+        }
+        alloc_tracking::reset_statistics();
+    }
+
+    TEST(utils, huge_page_allocator)
+    {
+        using small_arr_t = xarray<double, layout_type::row_major, huge_page_allocator<double>>;
+        small_arr_t a = {{1, 2, 3}, {5, 6, 7}};
+        small_arr_t b = a + 1.;
+        EXPECT_EQ(b(1, 2), 8.);
+        EXPECT_FALSE(huge_page_allocator<double>::is_mapped(b.size()));
+
+        using arr_t = xtensor<double, 1, layout_type::row_major,
+                              huge_page_allocator<double, numa_placement::parallel_first_touch>>;
+        std::size_t size = std::size_t(1) << 20;
+        arr_t c = arr_t::from_shape({size});
+        c.fill(2.);
+        EXPECT_EQ(c(size - 1), 2.);
+        arr_t d = c * 3.;
+        EXPECT_EQ(d(size / 2), 6.);
+
+#if defined(__linux__)
+        EXPECT_TRUE(arr_t::allocator_type::is_mapped(size));
+        EXPECT_EQ(arr_t::allocator_type::mapped_size(size) % XTENSOR_HUGE_PAGE_SIZE, 0u);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(c.data()) % XTENSOR_HUGE_PAGE_SIZE, 0u);
+#endif
+
+        huge_page_allocator<int, numa_placement::interleave> alloc;
+        int* p = alloc.allocate(size);
+        std::fill(p, p + size, 1);
+        EXPECT_EQ(std::accumulate(p, p + size, 0), static_cast<int>(size));
+        alloc.deallocate(p, size);
+
+        struct alignas(64) over_aligned
+        {
+            double value;
+        };
+        huge_page_allocator<over_aligned> over_alloc;
+        over_aligned* q = over_alloc.allocate(3);
+#if defined(__cpp_aligned_new)
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(q) % 64, 0u);
+#endif
+        over_alloc.deallocate(q, 3);
+
+        XT_EXPECT_THROW(alloc.allocate(alloc.max_size() + 1), std::bad_alloc);
+    }
+
+    TEST(utils, scoped_arena)
+    {
+        using arr_t = xtensor<double, 2, layout_type::row_major, arena_allocator<double>>;
+        arr_t a = arr_t::from_shape({50, 40});
+        a.fill(1.);
+        arr_t res;
+        {
+            scoped_arena arena(std::size_t(1) << 20);
+            EXPECT_EQ(scoped_arena::current(), &arena);
+            for (std::size_t i = 0; i < 10; ++i)
+            {
+                arr_t tmp = a + double(i);
+                res = tmp * 2.;
+            }
+            EXPECT_GT(arena.reused_count(), 0u);
+            EXPECT_LE(arena.cached_bytes(), arena.capacity());
+            {
+                scoped_arena inner(0);
+                EXPECT_EQ(scoped_arena::current(), &inner);
+                arr_t tmp = a * 3.;
+                EXPECT_EQ(tmp(49, 39), 3.);
+                EXPECT_EQ(inner.cached_bytes(), 0u);
+            }
+            EXPECT_EQ(scoped_arena::current(), &arena);
+        }
+        EXPECT_EQ(scoped_arena::current(), nullptr);
+        // buffers escaping the scope stay valid
+        EXPECT_EQ(res(49, 39), 20.);
+    }
+
     TEST(utils, static_dimension)
     {
         std::ptrdiff_t sdim = static_dimension<std::vector<int>>::value;